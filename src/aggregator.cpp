@@ -0,0 +1,163 @@
+#include "aggregator.h"
+
+static const char* const FIELD_NAMES[AGG_FIELD_COUNT] = {
+  "Battery", "Current", "Voltage", "RPM", "SpeedMode", "Mph"
+};
+
+TelemetryAggregator::TelemetryAggregator() {
+  tierCount = 0;
+  rawEnabled = true;
+  for (int f = 0; f < AGG_FIELD_COUNT; f++) lastValues[f] = 0;
+}
+
+void TelemetryAggregator::init() {
+  configure(AGG_DEFAULT_TIERS);
+  printConfig();
+}
+
+// Parses a comma-separated list of window periods in ms, e.g. "0,100,1000".
+// 0 enables the raw per-frame rows. Leaves the old tiers alone on bad input.
+bool TelemetryAggregator::configure(String spec) {
+  unsigned long periods[AGG_MAX_TIERS];
+  int count = 0;
+  bool raw = false;
+
+  spec.trim();
+  int start = 0;
+  while (start <= (int)spec.length()) {
+    int comma = spec.indexOf(',', start);
+    if (comma < 0) comma = spec.length();
+    String item = spec.substring(start, comma);
+    item.trim();
+    if (item.length() == 0) return false;
+    long period = item.toInt();
+    if (period < 0 || (period == 0 && item != "0")) return false;
+    if (period == 0) {
+      raw = true;
+    } else {
+      if (count >= AGG_MAX_TIERS) return false;
+      periods[count++] = period;
+    }
+    start = comma + 1;
+  }
+
+  unsigned long now = millis();
+  tierCount = count;
+  rawEnabled = raw;
+  for (int i = 0; i < tierCount; i++) {
+    tiers[i].periodMs = periods[i];
+    resetWindow(tiers[i], now);
+  }
+  return true;
+}
+
+bool TelemetryAggregator::isRawEnabled() {
+  return rawEnabled;
+}
+
+void TelemetryAggregator::resetWindow(AggregationTier& tier, unsigned long windowStart) {
+  tier.windowStart = windowStart;
+  tier.frames = 0;
+  tier.brakeCount = 0;
+  tier.regenCount = 0;
+  tier.reverseCount = 0;
+}
+
+void TelemetryAggregator::addFrame(const VehicleData& data) {
+  float values[AGG_FIELD_COUNT];
+  values[AGG_BATTERY] = data.battery;
+  values[AGG_CURRENT] = data.current;
+  values[AGG_VOLTAGE] = data.voltage;
+  values[AGG_RPM] = data.rpm;
+  values[AGG_SPEED_MODE] = data.speedMode;
+  values[AGG_MPH] = data.mph;
+  for (int f = 0; f < AGG_FIELD_COUNT; f++) lastValues[f] = values[f];
+
+  for (int t = 0; t < tierCount; t++) {
+    AggregationTier& tier = tiers[t];
+    for (int f = 0; f < AGG_FIELD_COUNT; f++) {
+      FieldStats& stats = tier.fields[f];
+      float value = values[f];
+      if (tier.frames == 0) {
+        stats.min = value;
+        stats.max = value;
+        stats.sum = 0;
+      } else {
+        if (value < stats.min) stats.min = value;
+        if (value > stats.max) stats.max = value;
+      }
+      stats.sum += value;
+      stats.last = value;
+    }
+    if (data.brake) tier.brakeCount++;
+    if (data.regen) tier.regenCount++;
+    if (data.reverseMode) tier.reverseCount++;
+    tier.frames++;
+  }
+}
+
+void TelemetryAggregator::update(unsigned long currentMillis) {
+  for (int t = 0; t < tierCount; t++) {
+    AggregationTier& tier = tiers[t];
+    if (currentMillis - tier.windowStart < tier.periodMs) continue;
+
+    emitTier(tier);
+    // Stay on the tier's cadence unless the loop stalled for a whole window
+    unsigned long nextStart = tier.windowStart + tier.periodMs;
+    if (currentMillis - nextStart >= tier.periodMs) nextStart = currentMillis;
+    resetWindow(tier, nextStart);
+  }
+}
+
+// AGG,PeriodMs,TimestampUs,Frames,<Field>Min,<Field>Max,<Field>Mean,<Field>Last...,Brake,Regen,Reverse
+void TelemetryAggregator::emitTier(AggregationTier& tier) {
+  Serial.print("AGG,");
+  Serial.print(tier.periodMs);
+  Serial.print(",");
+  Serial.print(latencyNowUs());
+  Serial.print(",");
+  Serial.print(tier.frames);
+  for (int f = 0; f < AGG_FIELD_COUNT; f++) {
+    FieldStats& stats = tier.fields[f];
+    // An empty window repeats the last known value in every column
+    bool empty = tier.frames == 0;
+    Serial.print(",");
+    Serial.print(empty ? lastValues[f] : stats.min, 2);
+    Serial.print(",");
+    Serial.print(empty ? lastValues[f] : stats.max, 2);
+    Serial.print(",");
+    Serial.print(empty ? lastValues[f] : stats.sum / tier.frames, 2);
+    Serial.print(",");
+    Serial.print(empty ? lastValues[f] : stats.last, 2);
+  }
+  Serial.print(",");
+  Serial.print(tier.brakeCount);
+  Serial.print(",");
+  Serial.print(tier.regenCount);
+  Serial.print(",");
+  Serial.println(tier.reverseCount);
+}
+
+void TelemetryAggregator::printConfig() {
+  Serial.print("# AGG tiers (ms): ");
+  Serial.print(rawEnabled ? "0" : "");
+  for (int t = 0; t < tierCount; t++) {
+    if (rawEnabled || t > 0) Serial.print(",");
+    Serial.print(tiers[t].periodMs);
+  }
+  Serial.println();
+
+  Serial.print("# AGG,PeriodMs,TimestampUs,Frames");
+  for (int f = 0; f < AGG_FIELD_COUNT; f++) {
+    Serial.print(",");
+    Serial.print(FIELD_NAMES[f]);
+    Serial.print("Min,");
+    Serial.print(FIELD_NAMES[f]);
+    Serial.print("Max,");
+    Serial.print(FIELD_NAMES[f]);
+    Serial.print("Mean,");
+    Serial.print(FIELD_NAMES[f]);
+    Serial.print("Last");
+  }
+  Serial.println(",Brake,Regen,Reverse");
+}
@@ -0,0 +1,62 @@
+#ifndef AGGREGATOR_H
+#define AGGREGATOR_H
+
+#include <Arduino.h>
+#include "logic.h"
+
+#define AGG_MAX_TIERS 4
+#define AGG_DEFAULT_TIERS "0,100,1000"  // Period in ms per tier; 0 is the raw per-frame row
+
+enum AggField {
+  AGG_BATTERY,
+  AGG_CURRENT,
+  AGG_VOLTAGE,
+  AGG_RPM,
+  AGG_SPEED_MODE,
+  AGG_MPH,
+  AGG_FIELD_COUNT
+};
+
+struct FieldStats {
+  float min;
+  float max;
+  float sum;
+  float last;
+};
+
+struct AggregationTier {
+  unsigned long periodMs;
+  unsigned long windowStart;
+  unsigned long frames;
+  FieldStats fields[AGG_FIELD_COUNT];
+  unsigned int brakeCount;
+  unsigned int regenCount;
+  unsigned int reverseCount;
+};
+
+// Summarizes SIF frames over fixed windows so a slow link or long-term log
+// keeps the shape of the signal without the full-rate stream. Each tier is
+// updated in O(1) per frame and emits one AGG row every window, with
+// Frames=0 and the last known values when none arrived (the dash doesn't
+// resend unchanged frames, so a steady signal is quiet on the SIF side).
+class TelemetryAggregator {
+private:
+  AggregationTier tiers[AGG_MAX_TIERS];
+  int tierCount;
+  bool rawEnabled;
+  float lastValues[AGG_FIELD_COUNT];  // Newest frame, carried into windows that get none
+
+  void resetWindow(AggregationTier& tier, unsigned long windowStart);
+  void emitTier(AggregationTier& tier);
+
+public:
+  TelemetryAggregator();
+  void init();
+  bool configure(String spec);
+  bool isRawEnabled();
+  void addFrame(const VehicleData& data);
+  void update(unsigned long currentMillis);
+  void printConfig();
+};
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef ARC_GAUGE_H
+#define ARC_GAUGE_H
+
+#include <stdint.h>
+#include "ui.h"
+
+// Compile-time rasterization of the arc tachometer. Each of the
+// GAUGE_SEGMENTS annular sectors is scan-converted into a list of horizontal
+// spans, so drawing a segment at runtime is just a few writeFastHLine calls.
+// Needs C++14 relaxed constexpr (see build flags in platformio.ini).
+
+static_assert(__cplusplus >= 201402L, "arc_gauge.h needs C++14 or newer");
+
+struct ArcSpan {
+  int16_t x;
+  int16_t y;
+  int16_t w;
+};
+
+template <int N>
+struct ArcSpanTable {
+  ArcSpan spans[N];
+  uint16_t first[GAUGE_SEGMENTS + 1];  // spans of segment i are [first[i], first[i + 1])
+  uint16_t pixels[GAUGE_SEGMENTS];
+};
+
+namespace arcgauge {
+
+constexpr double pi = 3.14159265358979323846;
+
+constexpr double sine(double x) {
+  while (x > pi) x -= 2 * pi;
+  while (x < -pi) x += 2 * pi;
+  double term = x;
+  double sum = x;
+  for (int n = 1; n < 12; n++) {
+    term *= -x * x / ((2 * n) * (2 * n + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double cosine(double x) {
+  return sine(x + pi / 2);
+}
+
+constexpr double squareRoot(double x) {
+  if (x <= 0) return 0;
+  double r = x > 1 ? x : 1;
+  for (int i = 0; i < 40; i++) r = 0.5 * (r + x / r);
+  return r;
+}
+
+constexpr int floorInt(double x) {
+  int i = (int)x;
+  return (i > x) ? i - 1 : i;
+}
+
+constexpr int ceilInt(double x) {
+  int i = (int)x;
+  return (i < x) ? i + 1 : i;
+}
+
+// Narrows [lo, hi] to the X values where a * X + b >= 0.
+constexpr bool clipHalfPlane(double a, double b, double& lo, double& hi) {
+  if (a > 1e-9) {
+    double bound = -b / a;
+    if (bound > lo) lo = bound;
+  } else if (a < -1e-9) {
+    double bound = -b / a;
+    if (bound < hi) hi = bound;
+  } else if (b < 0) {
+    return false;
+  }
+  return lo <= hi;
+}
+
+// Emits the pixels whose centers have X offsets in [a, b] on row y.
+constexpr int emitSpan(double a, double b, int y, ArcSpan* out, int count, uint16_t* pixels) {
+  int xStart = ceilInt(a + ARC_GAUGE_CENTER_X - 0.5);
+  int xEnd = floorInt(b + ARC_GAUGE_CENTER_X - 0.5);
+  if (xStart < 0) xStart = 0;
+  if (xEnd > SCREEN_WIDTH - 1) xEnd = SCREEN_WIDTH - 1;
+  if (xEnd < xStart) return count;
+  if (out) {
+    out[count].x = (int16_t)xStart;
+    out[count].y = (int16_t)y;
+    out[count].w = (int16_t)(xEnd - xStart + 1);
+    *pixels += xEnd - xStart + 1;
+  }
+  return count + 1;
+}
+
+// Scan-converts every segment. With out == nullptr it only counts spans, so
+// the same routine sizes the table and fills it.
+constexpr int rasterize(ArcSpan* out, uint16_t* first, uint16_t* pixels) {
+  const double outer2 = (double)ARC_GAUGE_OUTER_RADIUS * ARC_GAUGE_OUTER_RADIUS;
+  const double inner2 = (double)ARC_GAUGE_INNER_RADIUS * ARC_GAUGE_INNER_RADIUS;
+  const double step = (double)ARC_GAUGE_SWEEP_DEG / GAUGE_SEGMENTS;
+  int count = 0;
+
+  for (int segment = 0; segment < GAUGE_SEGMENTS; segment++) {
+    if (first) first[segment] = (uint16_t)count;
+    // Segments run clockwise from ARC_GAUGE_START_DEG (math angles, y up).
+    double a0 = (ARC_GAUGE_START_DEG - segment * step - ARC_GAUGE_GAP_DEG / 2.0) * pi / 180;
+    double a1 = (ARC_GAUGE_START_DEG - (segment + 1) * step + ARC_GAUGE_GAP_DEG / 2.0) * pi / 180;
+    double c0 = cosine(a0), s0 = sine(a0);
+    double c1 = cosine(a1), s1 = sine(a1);
+
+    int yTop = ARC_GAUGE_CENTER_Y - ARC_GAUGE_OUTER_RADIUS;
+    int yBottom = ARC_GAUGE_CENTER_Y + ARC_GAUGE_OUTER_RADIUS;
+    if (yTop < 0) yTop = 0;
+    if (yBottom > SCREEN_HEIGHT - 1) yBottom = SCREEN_HEIGHT - 1;
+
+    for (int y = yTop; y <= yBottom; y++) {
+      double Y = ARC_GAUGE_CENTER_Y - (y + 0.5);
+      if (Y * Y >= outer2) continue;
+
+      // Inside the wedge: counter-clockwise of edge a1 and clockwise of a0.
+      double lo = -1e9, hi = 1e9;
+      if (!clipHalfPlane(-s1, c1 * Y, lo, hi)) continue;
+      if (!clipHalfPlane(s0, -c0 * Y, lo, hi)) continue;
+
+      double outerHalf = squareRoot(outer2 - Y * Y);
+      double innerHalf = (Y * Y < inner2) ? squareRoot(inner2 - Y * Y) : 0;
+      uint16_t* segmentPixels = pixels ? &pixels[segment] : nullptr;
+
+      if (innerHalf > 0) {
+        double a = lo > -outerHalf ? lo : -outerHalf;
+        double b = hi < -innerHalf ? hi : -innerHalf;
+        if (a <= b) count = emitSpan(a, b, y, out, count, segmentPixels);
+        a = lo > innerHalf ? lo : innerHalf;
+        b = hi < outerHalf ? hi : outerHalf;
+        if (a <= b) count = emitSpan(a, b, y, out, count, segmentPixels);
+      } else {
+        double a = lo > -outerHalf ? lo : -outerHalf;
+        double b = hi < outerHalf ? hi : outerHalf;
+        if (a <= b) count = emitSpan(a, b, y, out, count, segmentPixels);
+      }
+    }
+  }
+  if (first) first[GAUGE_SEGMENTS] = (uint16_t)count;
+  return count;
+}
+
+template <int N>
+constexpr ArcSpanTable<N> build() {
+  ArcSpanTable<N> table{};
+  rasterize(table.spans, table.first, table.pixels);
+  return table;
+}
+
+}  // namespace arcgauge
+
+#define ARC_SPAN_COUNT (arcgauge::rasterize(nullptr, nullptr, nullptr))
+
+static constexpr ArcSpanTable<ARC_SPAN_COUNT> ARC_SPANS = arcgauge::build<ARC_SPAN_COUNT>();
+
+#endif
@@ -0,0 +1,134 @@
+#include "display_transport.h"
+#include <string.h>
+
+DisplayTransport::DisplayTransport() {
+  filling = 0;
+  for (int i = 0; i < 2; i++) {
+    inFlight[i] = false;
+    needsReset[i] = false;
+  }
+  completedFence = 0;
+  completedUs = 0;
+  nextFence = 0;
+  memset(&stats, 0, sizeof(stats));
+  resetBatch(batches[0]);
+  resetBatch(batches[1]);
+}
+
+void DisplayTransport::resetBatch(DisplayBatch& batch) {
+  batch.count = 0;
+  batch.pixels = 0;
+  batch.fence = 0;
+}
+
+// The buffer being filled may still be on the bus from the frame before
+// last; that's the only place drawing ever waits. A submitted buffer keeps
+// its old commands until it is emptied here, whether or not we had to wait.
+DisplayBatch& DisplayTransport::fillingBatch() {
+  if (inFlight[filling]) {
+    uint64_t start = nowUs();
+    while (inFlight[filling]) waitForBatch();
+    stats.stallUs += nowUs() - start;
+  }
+  if (needsReset[filling]) {
+    resetBatch(batches[filling]);
+    needsReset[filling] = false;
+  }
+  return batches[filling];
+}
+
+void DisplayTransport::submit() {
+  int index = filling;
+  inFlight[index] = true;
+  needsReset[index] = true;
+  stats.batches++;
+  startBatch(batches[index], index);
+  filling = 1 - filling;
+}
+
+void DisplayTransport::fill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+  if (w == 0 || h == 0) return;
+  DisplayBatch* batch = &fillingBatch();
+  uint32_t pixels = (uint32_t)w * h;
+
+  // Text and arc spans arrive a pixel, glyph dot or line at a time; growing
+  // the previous window saves an 11-byte address window and a few DMA
+  // transactions per run.
+  if (batch->count > 0) {
+    DisplayCommand& last = batch->commands[batch->count - 1];
+    bool grown = false;
+    if (last.color == color && last.h == 1 && h == 1 && last.y == y && last.x + last.w == x) {
+      last.w += w;
+      grown = true;
+    } else if (last.color == color && last.w == w && last.x == x && last.y + last.h == y) {
+      last.h += h;
+      grown = true;
+    }
+    if (grown) {
+      batch->pixels += pixels;
+      stats.pixels += pixels;
+      stats.coalesced++;
+      return;
+    }
+  }
+
+  if (batch->count == DISPLAY_BATCH_COMMANDS) {
+    submit();
+    batch = &fillingBatch();
+  }
+  DisplayCommand& command = batch->commands[batch->count++];
+  command.x = x;
+  command.y = y;
+  command.w = w;
+  command.h = h;
+  command.color = color;
+  batch->pixels += pixels;
+  stats.pixels += pixels;
+  stats.commands++;
+}
+
+// Closes the frame and starts it on the bus. The returned fence completes
+// when the frame's last pixel (and everything queued before it) is out. A
+// frame that drew nothing isn't sent or counted; it gets the previous fence.
+uint32_t DisplayTransport::endFrame() {
+  DisplayBatch& batch = fillingBatch();
+  if (batch.count == 0) return nextFence;
+  if (++nextFence == 0) nextFence = 1;
+  batch.fence = nextFence;
+  stats.frames++;
+  submit();
+  return nextFence;
+}
+
+bool DisplayTransport::isComplete(uint32_t fence) {
+  return fence == 0 || (int32_t)(completedFence - fence) >= 0;
+}
+
+void DisplayTransport::waitFor(uint32_t fence) {
+  while (!isComplete(fence)) waitForBatch();
+}
+
+// Completion time of the newest completed fence. The backend may finish a
+// batch while this runs, so re-read until the fence didn't move.
+uint64_t DisplayTransport::fenceCompletedUs() {
+  uint32_t fence;
+  uint64_t doneUs;
+  do {
+    fence = completedFence;
+    doneUs = completedUs;
+  } while (fence != completedFence);
+  return doneUs;
+}
+
+const DisplayTransportStats& DisplayTransport::getStats() {
+  return stats;
+}
+
+// Called by the backend, possibly from its own task.
+void DisplayTransport::batchComplete(int index, uint64_t doneUs) {
+  if (batches[index].fence != 0) {
+    completedUs = doneUs;
+    completedFence = batches[index].fence;
+  }
+  inFlight[index] = false;
+}
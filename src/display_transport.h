@@ -0,0 +1,76 @@
+#ifndef DISPLAY_TRANSPORT_H
+#define DISPLAY_TRANSPORT_H
+
+#include <stdint.h>
+
+// Board-independent half of the display transport. Drawing queues
+// address-window + solid pixel-run commands into one of two descriptor
+// buffers and returns; a backend ships the other buffer to the panel in the
+// background. No Arduino or IDF headers here, so the host simulator in
+// tools/display_sim builds it unchanged.
+
+#define DISPLAY_BATCH_COMMANDS 256     // Commands per descriptor buffer
+#define DISPLAY_DMA_CHUNK_PIXELS 1024  // Pixels per DMA transaction (one solid-colour buffer)
+#define DISPLAY_WINDOW_BYTES 11        // CASET + 4, RASET + 4 and RAMWR bytes per command
+
+struct DisplayCommand {
+  uint16_t x;  // Panel coordinates, rotation offsets already applied
+  uint16_t y;
+  uint16_t w;
+  uint16_t h;
+  uint16_t color;  // RGB565, every pixel of the window
+};
+
+struct DisplayBatch {
+  DisplayCommand commands[DISPLAY_BATCH_COMMANDS];
+  int count;
+  uint32_t pixels;
+  uint32_t fence;  // Frame fence closed by this batch, 0 for a mid-frame flush
+};
+
+struct DisplayTransportStats {
+  uint32_t frames;
+  uint32_t batches;
+  uint32_t commands;   // Address windows sent
+  uint32_t coalesced;  // Runs merged into the previous command instead
+  uint64_t pixels;
+  uint64_t stallUs;    // Time drawing waited for a free descriptor buffer
+};
+
+class DisplayTransport {
+private:
+  DisplayBatch batches[2];
+  int filling;
+  volatile bool inFlight[2];
+  bool needsReset[2];  // Submitted since it was last emptied
+  volatile uint32_t completedFence;
+  volatile uint64_t completedUs;
+  uint32_t nextFence;
+  DisplayTransportStats stats;
+
+  DisplayBatch& fillingBatch();
+  void resetBatch(DisplayBatch& batch);
+  void submit();
+
+protected:
+  // startBatch() hands a batch to the bus and returns at once. The backend
+  // calls batchComplete() when its last pixel is out; batches complete in
+  // the order they were started. waitForBatch() blocks until at least one
+  // more batch has completed.
+  virtual void startBatch(const DisplayBatch& batch, int index) = 0;
+  virtual void waitForBatch() = 0;
+  virtual uint64_t nowUs() = 0;
+  void batchComplete(int index, uint64_t doneUs);
+
+public:
+  DisplayTransport();
+  virtual ~DisplayTransport() {}
+  void fill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+  uint32_t endFrame();
+  bool isComplete(uint32_t fence);
+  void waitFor(uint32_t fence);
+  uint64_t fenceCompletedUs();
+  const DisplayTransportStats& getStats();
+};
+
+#endif
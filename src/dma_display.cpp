@@ -0,0 +1,308 @@
+#include "dma_display.h"
+#include "driver/gpio.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include <string.h>
+
+struct QueuedBatch {
+  const DisplayBatch* batch;
+  int index;
+};
+
+static int dcPin = -1;
+
+// Runs in the SPI ISR just before each transaction; `user` carries D/C.
+static void IRAM_ATTR setDcBeforeTransfer(spi_transaction_t* transaction) {
+  gpio_set_level((gpio_num_t)dcPin, (int)(intptr_t)transaction->user);
+}
+
+SpiDmaTransport::SpiDmaTransport() {
+  device = nullptr;
+  task = nullptr;
+  batchQueue = nullptr;
+  batchDone = nullptr;
+  queuedCount = 0;
+  finishedCount = 0;
+  for (int i = 0; i < 2; i++) {
+    colorBuffers[i] = nullptr;
+    bufferColor[i] = 0;
+    bufferPixels[i] = 0;
+    bufferLastUse[i] = 0;
+  }
+  nextBuffer = 0;
+}
+
+// Takes the bus over from the Arduino SPI driver once the panel has been
+// initialized through Adafruit_ST7789.
+bool SpiDmaTransport::begin(int8_t sck, int8_t mosi, int8_t cs, int8_t dc) {
+  for (int i = 0; i < 2; i++) {
+    colorBuffers[i] = (uint16_t*)heap_caps_malloc(DISPLAY_DMA_CHUNK_PIXELS * sizeof(uint16_t), MALLOC_CAP_DMA);
+    if (!colorBuffers[i]) return false;
+  }
+  batchQueue = xQueueCreate(2, sizeof(QueuedBatch));
+  batchDone = xSemaphoreCreateBinary();
+  if (!batchQueue || !batchDone) return false;
+
+  spi_bus_config_t bus = {};
+  bus.mosi_io_num = mosi;
+  bus.miso_io_num = -1;
+  bus.sclk_io_num = sck;
+  bus.quadwp_io_num = -1;
+  bus.quadhd_io_num = -1;
+  bus.max_transfer_sz = DISPLAY_DMA_CHUNK_PIXELS * sizeof(uint16_t);
+  if (spi_bus_initialize(DISPLAY_SPI_HOST, &bus, SPI_DMA_CH_AUTO) != ESP_OK) return false;
+
+  spi_device_interface_config_t config = {};
+  config.clock_speed_hz = DISPLAY_SPI_HZ;
+  config.mode = 0;
+  config.spics_io_num = cs;
+  config.queue_size = DISPLAY_SPI_QUEUE;
+  config.pre_cb = setDcBeforeTransfer;
+  if (spi_bus_add_device(DISPLAY_SPI_HOST, &config, &device) != ESP_OK) {
+    spi_bus_free(DISPLAY_SPI_HOST);
+    return false;
+  }
+
+  dcPin = dc;
+  return xTaskCreate(taskEntry, "display_dma", DISPLAY_TASK_STACK, this, DISPLAY_TASK_PRIORITY, &task) == pdPASS;
+}
+
+void SpiDmaTransport::taskEntry(void* arg) {
+  SpiDmaTransport* self = (SpiDmaTransport*)arg;
+  QueuedBatch next;
+  for (;;) {
+    if (xQueueReceive(self->batchQueue, &next, portMAX_DELAY) != pdTRUE) continue;
+    for (int i = 0; i < next.batch->count; i++) {
+      self->shipCommand(next.batch->commands[i]);
+    }
+    // The batch (and its fence) is only done once the bus has drained
+    self->drainTo(self->queuedCount);
+    self->batchComplete(next.index, esp_timer_get_time());
+    xSemaphoreGive(self->batchDone);
+  }
+}
+
+void SpiDmaTransport::startBatch(const DisplayBatch& batch, int index) {
+  QueuedBatch queued = {&batch, index};
+  xQueueSend(batchQueue, &queued, portMAX_DELAY);
+}
+
+void SpiDmaTransport::waitForBatch() {
+  xSemaphoreTake(batchDone, portMAX_DELAY);
+}
+
+uint64_t SpiDmaTransport::nowUs() {
+  return (uint64_t)esp_timer_get_time();
+}
+
+void SpiDmaTransport::shipCommand(const DisplayCommand& command) {
+  uint16_t x1 = command.x + command.w - 1;
+  uint16_t y1 = command.y + command.h - 1;
+  uint8_t columns[4] = {(uint8_t)(command.x >> 8), (uint8_t)command.x, (uint8_t)(x1 >> 8), (uint8_t)x1};
+  uint8_t rows[4] = {(uint8_t)(command.y >> 8), (uint8_t)command.y, (uint8_t)(y1 >> 8), (uint8_t)y1};
+  uint8_t opcode;
+
+  opcode = ST77XX_CASET;
+  queueSmall(false, &opcode, 1);
+  queueSmall(true, columns, 4);
+  opcode = ST77XX_RASET;
+  queueSmall(false, &opcode, 1);
+  queueSmall(true, rows, 4);
+  opcode = ST77XX_RAMWR;
+  queueSmall(false, &opcode, 1);
+
+  // Every chunk of the run reads the same solid-colour buffer
+  uint32_t remaining = (uint32_t)command.w * command.h;
+  int buffer = colorBuffer(command.color, min(remaining, (uint32_t)DISPLAY_DMA_CHUNK_PIXELS));
+  while (remaining > 0) {
+    uint32_t pixels = min(remaining, (uint32_t)DISPLAY_DMA_CHUNK_PIXELS);
+    spi_transaction_t* transaction = nextTransaction();
+    transaction->length = pixels * 16;
+    transaction->tx_buffer = colorBuffers[buffer];
+    transaction->user = (void*)1;
+    queueTransaction(transaction);
+    remaining -= pixels;
+  }
+  bufferLastUse[buffer] = queuedCount;
+}
+
+// Returns a buffer holding at least `pixels` copies of color. A buffer is
+// only rewritten once the bus is done reading it.
+int SpiDmaTransport::colorBuffer(uint16_t color, uint32_t pixels) {
+  uint16_t swapped = (color >> 8) | (color << 8);  // The panel takes RGB565 big-endian
+  int buffer = -1;
+  for (int i = 0; i < 2; i++) {
+    if (bufferPixels[i] > 0 && bufferColor[i] == swapped) buffer = i;
+  }
+  if (buffer < 0) {
+    buffer = nextBuffer;
+    drainTo(bufferLastUse[buffer]);
+    bufferColor[buffer] = swapped;
+    bufferPixels[buffer] = 0;
+  }
+  // Growing a buffer in place is safe: in-flight reads only cover the part
+  // already written, with the same value.
+  uint16_t* data = colorBuffers[buffer];
+  for (uint32_t i = bufferPixels[buffer]; i < pixels; i++) data[i] = swapped;
+  if (pixels > bufferPixels[buffer]) bufferPixels[buffer] = pixels;
+  nextBuffer = 1 - buffer;  // Next new colour replaces the least recently used one
+  return buffer;
+}
+
+// Transaction slots are reused in order; once all are queued, wait for the
+// oldest to come back.
+spi_transaction_t* SpiDmaTransport::nextTransaction() {
+  if (queuedCount - finishedCount >= DISPLAY_SPI_QUEUE) drainTo(finishedCount + 1);
+  spi_transaction_t* transaction = &transactions[queuedCount % DISPLAY_SPI_QUEUE];
+  memset(transaction, 0, sizeof(spi_transaction_t));
+  return transaction;
+}
+
+void SpiDmaTransport::queueTransaction(spi_transaction_t* transaction) {
+  spi_device_queue_trans(device, transaction, portMAX_DELAY);
+  queuedCount++;
+}
+
+// Command opcodes and window parameters fit in the transaction itself.
+void SpiDmaTransport::queueSmall(bool data, const uint8_t* bytes, int length) {
+  spi_transaction_t* transaction = nextTransaction();
+  transaction->flags = SPI_TRANS_USE_TXDATA;
+  transaction->length = length * 8;
+  memcpy(transaction->tx_data, bytes, length);
+  transaction->user = (void*)(intptr_t)(data ? 1 : 0);
+  queueTransaction(transaction);
+}
+
+void SpiDmaTransport::drainTo(uint32_t count) {
+  spi_transaction_t* done;
+  while ((int32_t)(count - finishedCount) > 0) {
+    spi_device_get_trans_result(device, &done, portMAX_DELAY);
+    finishedCount++;
+  }
+}
+
+AsyncST7789::AsyncST7789(int8_t cs, int8_t dc, int8_t rst) : Adafruit_ST7789(cs, dc, rst) {
+  transport = nullptr;
+  syncFence = 0;
+  syncDoneUs = 0;
+}
+
+void AsyncST7789::attachTransport(DisplayTransport* displayTransport) {
+  transport = displayTransport;
+}
+
+// Marks the end of a frame's drawing. Without a transport the frame is
+// already on the glass.
+uint32_t AsyncST7789::endFrame() {
+  if (transport) return transport->endFrame();
+  syncDoneUs = (uint64_t)esp_timer_get_time();
+  return ++syncFence;
+}
+
+bool AsyncST7789::isFrameComplete(uint32_t fence) {
+  return transport ? transport->isComplete(fence) : true;
+}
+
+void AsyncST7789::waitForFrame(uint32_t fence) {
+  if (transport) transport->waitFor(fence);
+}
+
+uint64_t AsyncST7789::frameCompletedUs() {
+  return transport ? transport->fenceCompletedUs() : syncDoneUs;
+}
+
+void AsyncST7789::printStats() {
+  if (!transport) {
+    Serial.println("# DISPLAY synchronous (no DMA transport)");
+    return;
+  }
+  const DisplayTransportStats& stats = transport->getStats();
+  Serial.print("# DISPLAY frames: ");
+  Serial.print(stats.frames);
+  Serial.print(", batches: ");
+  Serial.print(stats.batches);
+  Serial.print(", windows: ");
+  Serial.print(stats.commands);
+  Serial.print(", coalesced: ");
+  Serial.print(stats.coalesced);
+  Serial.print(", px/frame: ");
+  Serial.print(stats.frames ? (unsigned long)(stats.pixels / stats.frames) : 0);
+  Serial.print(", stall us/frame: ");
+  Serial.println(stats.frames ? (unsigned long)(stats.stallUs / stats.frames) : 0);
+}
+
+bool AsyncST7789::clip(int16_t& x, int16_t& y, int16_t& w, int16_t& h) {
+  if (w < 0) {
+    x += w + 1;
+    w = -w;
+  }
+  if (h < 0) {
+    y += h + 1;
+    h = -h;
+  }
+  if (x < 0) {
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    h += y;
+    y = 0;
+  }
+  if ((int32_t)x + w > width()) w = width() - x;
+  if ((int32_t)y + h > height()) h = height() - y;
+  return w > 0 && h > 0;
+}
+
+void AsyncST7789::queueFill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (!clip(x, y, w, h)) return;
+  transport->fill(x + _xstart, y + _ystart, w, h, color);
+}
+
+// Transactions belong to the transport; nothing to open or close.
+void AsyncST7789::startWrite(void) {
+  if (!transport) Adafruit_ST7789::startWrite();
+}
+
+void AsyncST7789::endWrite(void) {
+  if (!transport) Adafruit_ST7789::endWrite();
+}
+
+void AsyncST7789::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (transport) queueFill(x, y, 1, 1, color);
+  else Adafruit_ST7789::drawPixel(x, y, color);
+}
+
+void AsyncST7789::writePixel(int16_t x, int16_t y, uint16_t color) {
+  if (transport) queueFill(x, y, 1, 1, color);
+  else Adafruit_ST7789::writePixel(x, y, color);
+}
+
+void AsyncST7789::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (transport) queueFill(x, y, w, h, color);
+  else Adafruit_ST7789::fillRect(x, y, w, h, color);
+}
+
+void AsyncST7789::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (transport) queueFill(x, y, w, h, color);
+  else Adafruit_ST7789::writeFillRect(x, y, w, h, color);
+}
+
+void AsyncST7789::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  if (transport) queueFill(x, y, w, 1, color);
+  else Adafruit_ST7789::drawFastHLine(x, y, w, color);
+}
+
+void AsyncST7789::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  if (transport) queueFill(x, y, w, 1, color);
+  else Adafruit_ST7789::writeFastHLine(x, y, w, color);
+}
+
+void AsyncST7789::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  if (transport) queueFill(x, y, 1, h, color);
+  else Adafruit_ST7789::drawFastVLine(x, y, h, color);
+}
+
+void AsyncST7789::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  if (transport) queueFill(x, y, 1, h, color);
+  else Adafruit_ST7789::writeFastVLine(x, y, h, color);
+}
@@ -0,0 +1,91 @@
+#ifndef DMA_DISPLAY_H
+#define DMA_DISPLAY_H
+
+#include <Adafruit_ST7789.h>
+#include "driver/spi_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "display_transport.h"
+
+#define DISPLAY_SPI_HOST SPI2_HOST     // FSPI, the bus SPI.begin() set up
+#define DISPLAY_SPI_HZ 40000000
+#define DISPLAY_SPI_QUEUE 16           // Transactions handed to the SPI driver at once
+#define DISPLAY_TASK_PRIORITY 2        // Above loop() so the bus is refilled as soon as a transaction lands
+#define DISPLAY_TASK_STACK 4096
+
+// Ships DisplayTransport batches through the IDF SPI master driver. A task
+// turns each command into CASET/RASET/RAMWR plus DMA transactions out of a
+// solid-colour buffer, then blocks in the driver while the bytes shift out,
+// so loop() keeps the CPU for the whole transfer.
+class SpiDmaTransport : public DisplayTransport {
+private:
+  spi_device_handle_t device;
+  TaskHandle_t task;
+  QueueHandle_t batchQueue;
+  SemaphoreHandle_t batchDone;
+  spi_transaction_t transactions[DISPLAY_SPI_QUEUE];
+  uint32_t queuedCount;     // Transactions handed to the driver
+  uint32_t finishedCount;   // Transactions the driver has handed back
+  uint16_t* colorBuffers[2];
+  uint16_t bufferColor[2];
+  uint32_t bufferPixels[2];
+  uint32_t bufferLastUse[2];  // queuedCount after the last transaction reading the buffer
+  int nextBuffer;
+
+  static void taskEntry(void* arg);
+  void shipCommand(const DisplayCommand& command);
+  int colorBuffer(uint16_t color, uint32_t pixels);
+  spi_transaction_t* nextTransaction();
+  void queueTransaction(spi_transaction_t* transaction);
+  void queueSmall(bool data, const uint8_t* bytes, int length);
+  void drainTo(uint32_t count);
+
+protected:
+  void startBatch(const DisplayBatch& batch, int index);
+  void waitForBatch();
+  uint64_t nowUs();
+
+public:
+  SpiDmaTransport();
+  bool begin(int8_t sck, int8_t mosi, int8_t cs, int8_t dc);
+};
+
+// ST7789 whose fill primitives (and so text, lines, circles and triangles,
+// which Adafruit_GFX builds from them) go through a DisplayTransport
+// instead of blocking on SPI. Without a transport attached it draws
+// synchronously like the base class. Once attached, the transport owns the
+// bus: bitmap pushes and panel commands (setRotation, invertDisplay) must
+// happen before attachTransport().
+class AsyncST7789 : public Adafruit_ST7789 {
+private:
+  DisplayTransport* transport;
+  uint32_t syncFence;
+  uint64_t syncDoneUs;
+
+  bool clip(int16_t& x, int16_t& y, int16_t& w, int16_t& h);
+  void queueFill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+public:
+  AsyncST7789(int8_t cs, int8_t dc, int8_t rst);
+  void attachTransport(DisplayTransport* displayTransport);
+  uint32_t endFrame();
+  bool isFrameComplete(uint32_t fence);
+  void waitForFrame(uint32_t fence);
+  uint64_t frameCompletedUs();
+  void printStats();
+
+  void startWrite(void);
+  void endWrite(void);
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  void writePixel(int16_t x, int16_t y, uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+};
+
+#endif
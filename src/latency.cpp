@@ -0,0 +1,71 @@
+#include "latency.h"
+#include <algorithm>
+
+static const char* const STAGE_NAMES[LATENCY_STAGE_COUNT] = {"parse", "publish", "draw", "glass"};
+
+LatencyTracker::LatencyTracker() {
+  for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+    sampleCount[stage] = 0;
+    nextSample[stage] = 0;
+  }
+  lastDrawnCapture = 0;
+}
+
+void LatencyTracker::addSample(LatencyStage stage, const FrameStamps& stamps) {
+  if (stamps.stageUs[stage] < stamps.captureUs) return;
+  samples[stage][nextSample[stage]] = (uint32_t)(stamps.stageUs[stage] - stamps.captureUs);
+  nextSample[stage] = (nextSample[stage] + 1) % LATENCY_WINDOW;
+  if (sampleCount[stage] < LATENCY_WINDOW) sampleCount[stage]++;
+}
+
+void LatencyTracker::recordParsed(const FrameStamps& stamps) {
+  if (stamps.captureUs == 0) return;
+  addSample(LATENCY_PARSE, stamps);
+  addSample(LATENCY_PUBLISH, stamps);
+}
+
+// The display redraws on its own cadence, so the same frame can be shown
+// several times; only its first trip to the glass counts.
+void LatencyTracker::recordDrawn(const FrameStamps& stamps) {
+  if (stamps.captureUs == 0 || stamps.captureUs == lastDrawnCapture) return;
+  lastDrawnCapture = stamps.captureUs;
+  addSample(LATENCY_DRAW_START, stamps);
+  addSample(LATENCY_SPI_DONE, stamps);
+}
+
+uint32_t LatencyTracker::percentile(LatencyStage stage, int pct) {
+  int count = sampleCount[stage];
+  if (count == 0) return 0;
+  uint32_t sorted[LATENCY_WINDOW];
+  std::copy(samples[stage], samples[stage] + count, sorted);
+  int rank = (count * pct + 99) / 100 - 1;
+  rank = constrain(rank, 0, count - 1);
+  std::nth_element(sorted, sorted + rank, sorted + count);
+  return sorted[rank];
+}
+
+void LatencyTracker::printReport() {
+  Serial.print("# LATENCY (us since capture, last ");
+  Serial.print(sampleCount[LATENCY_SPI_DONE]);
+  Serial.println(" drawn frames)");
+  for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+    Serial.print("#   ");
+    Serial.print(STAGE_NAMES[stage]);
+    Serial.print(": p50 ");
+    Serial.print(percentile((LatencyStage)stage, 50));
+    Serial.print(", p99 ");
+    Serial.println(percentile((LatencyStage)stage, 99));
+  }
+}
+
+// LAT,ParseP50,ParseP99,PublishP50,PublishP99,DrawP50,DrawP99,GlassP50,GlassP99
+void LatencyTracker::sendTelemetry() {
+  Serial.print("LAT");
+  for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+    Serial.print(",");
+    Serial.print(percentile((LatencyStage)stage, 50));
+    Serial.print(",");
+    Serial.print(percentile((LatencyStage)stage, 99));
+  }
+  Serial.println();
+}
@@ -0,0 +1,48 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <Arduino.h>
+#include "esp_timer.h"
+
+#define LATENCY_WINDOW 128       // Frames kept per stage for the rolling percentiles
+#define LATENCY_REPORT_MS 1000   // Cadence of the LAT telemetry row
+
+enum LatencyStage {
+  LATENCY_PARSE,        // Bytes decoded into VehicleData fields
+  LATENCY_PUBLISH,      // VehicleData complete and visible to the rest of loop()
+  LATENCY_DRAW_START,   // First widget of the frame starts drawing
+  LATENCY_SPI_DONE,     // Last pixel of the frame has left the SPI bus
+  LATENCY_STAGE_COUNT
+};
+
+// Timestamps (esp_timer microseconds) a frame picks up on its way to the
+// glass. captureUs is taken in the SIF ISR when the frame's last bit lands;
+// 0 means the data didn't come from a traced frame.
+struct FrameStamps {
+  uint64_t captureUs;
+  uint64_t stageUs[LATENCY_STAGE_COUNT];
+};
+
+inline uint64_t latencyNowUs() {
+  return (uint64_t)esp_timer_get_time();
+}
+
+class LatencyTracker {
+private:
+  uint32_t samples[LATENCY_STAGE_COUNT][LATENCY_WINDOW];  // Microseconds since capture
+  int sampleCount[LATENCY_STAGE_COUNT];
+  int nextSample[LATENCY_STAGE_COUNT];
+  uint64_t lastDrawnCapture;
+
+  void addSample(LatencyStage stage, const FrameStamps& stamps);
+
+public:
+  LatencyTracker();
+  void recordParsed(const FrameStamps& stamps);
+  void recordDrawn(const FrameStamps& stamps);
+  uint32_t percentile(LatencyStage stage, int pct);
+  void printReport();
+  void sendTelemetry();
+};
+
+#endif
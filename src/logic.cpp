@@ -12,8 +12,14 @@ VehicleLogic::VehicleLogic() {
   data.usingSifData = true;
   data.mph = 0;
   data.displayedRpm = 0;
+  data.frame = FrameStamps();
   lastPythonData = 0;
   targetRpm = 0;
+  filteredRpm = 0;
+  rpmVelocity = 0;
+  rpmTrend = 0;
+  lastFrameUs = 0;
+  lastAnimationUs = 0;
 }
 
 void VehicleLogic::init() {
@@ -42,7 +48,7 @@ void VehicleLogic::parsePythonData(String inputData) {
       
       int newRpm = constrain(values[1].toInt(), MIN_RPM, MAX_RPM);
       data.rpm = newRpm;
-      targetRpm = newRpm;
+      setTargetRpm(newRpm);
       
       byte newSpeedMode = constrain(values[2].toInt(), 1, MAX_SPEED_MODES);
       if (isValidSpeedMode(newSpeedMode)) {
@@ -55,25 +61,30 @@ void VehicleLogic::parsePythonData(String inputData) {
       data.current = values[6].toInt();
       data.voltage = values[7].toFloat();
       data.mph = calculateMph(data.rpm);
+      data.frame = FrameStamps();  // Python frames aren't latency traced
     }
   }
 }
 
-void VehicleLogic::parseSifData(byte sifData[12]) {
+void VehicleLogic::parseSifData(byte sifData[12], uint64_t captureUs) {
+  data.frame = FrameStamps();
+  data.frame.captureUs = captureUs;
+  
   // Use exact Arduino Nano mapping that worked
   data.battery = sifData[9];
   data.current = sifData[6];
- data.rpm = ((sifData[7] << 8) + sifData[8]) * 1.91;
-targetRpm = data.rpm;
-data.displayedRpm = data.rpm;  // Remove animation for testing
+  data.rpm = ((sifData[7] << 8) + sifData[8]) * 1.91;
+  setTargetRpm(constrain(data.rpm, MIN_RPM, MAX_RPM));
   data.voltage = sifData[1] * 0.75;  // Fixed: was sifData[10], should be sifData[1]
   
   data.brake = bitRead(sifData[4], 5);
   data.regen = bitRead(sifData[4], 3);
   data.reverseMode = (sifData[5] == 4);
   data.speedMode = sifData[4] & 0x07;
+  data.frame.stageUs[LATENCY_PARSE] = latencyNowUs();
   
   data.mph = calculateMph(data.rpm);
+  data.frame.stageUs[LATENCY_PUBLISH] = latencyNowUs();
 }
 
 void VehicleLogic::updateDataSource() {
@@ -83,14 +94,58 @@ void VehicleLogic::updateDataSource() {
   updateRpmAnimation();
 }
 
-void VehicleLogic::updateRpmAnimation() {
-  int rpmDiff = targetRpm - data.displayedRpm;
-  if (abs(rpmDiff) > 1) {
-    data.displayedRpm += rpmDiff / RPM_ANIMATION_SPEED + (rpmDiff > 0 ? 1 : -1);
+void VehicleLogic::setTargetRpm(int rpm) {
+  unsigned long now = micros();
+  unsigned long gap = now - lastFrameUs;
+  if (lastFrameUs != 0 && gap > 0 && gap < RPM_TREND_MAX_GAP_US) {
+    rpmTrend = (float)(rpm - targetRpm) / gap;
   } else {
-    data.displayedRpm = targetRpm;
+    rpmTrend = 0;
   }
-  data.displayedRpm = constrain(data.displayedRpm, MIN_RPM, MAX_RPM);
+  targetRpm = rpm;
+  lastFrameUs = now;
+}
+
+// Moves the needle toward where the RPM is predicted to be right now, using
+// the real time since the last call so the response doesn't depend on how
+// fast loop() spins. The trend of the last two frames is extrapolated for up
+// to RPM_PREDICT_MAX_US to hide the SIF frame interval, then faded out over
+// RPM_TREND_DECAY_US: the dash only delivers frames whose contents change,
+// so at a steady speed no new frame arrives to cancel the trend. The needle
+// follows that prediction as a critically damped spring (solved exactly over
+// dt, so it stays stable for any step size).
+void VehicleLogic::updateRpmAnimation() {
+  unsigned long now = micros();
+  unsigned long stepUs = now - lastAnimationUs;
+  lastAnimationUs = now;
+  if (stepUs > RPM_ANIMATION_MAX_STEP_US) stepUs = RPM_ANIMATION_MAX_STEP_US;
+  
+  unsigned long sinceFrame = now - lastFrameUs;
+  float leadUs = sinceFrame;
+  if (sinceFrame >= RPM_PREDICT_MAX_US + RPM_TREND_DECAY_US) {
+    leadUs = 0;
+  } else if (sinceFrame > RPM_PREDICT_MAX_US) {
+    leadUs = RPM_PREDICT_MAX_US * (float)(RPM_PREDICT_MAX_US + RPM_TREND_DECAY_US - sinceFrame) / RPM_TREND_DECAY_US;
+  }
+  float predicted = targetRpm + rpmTrend * leadUs;
+  predicted = constrain(predicted, (float)MIN_RPM, (float)MAX_RPM);
+  
+  float dt = stepUs / 1000000.0f;
+  float error = filteredRpm - predicted;
+  float decay = expf(-RPM_FILTER_OMEGA * dt);
+  float c = rpmVelocity + RPM_FILTER_OMEGA * error;
+  filteredRpm = predicted + (error + c * dt) * decay;
+  rpmVelocity = (rpmVelocity - RPM_FILTER_OMEGA * c * dt) * decay;
+  
+  if (filteredRpm >= MAX_RPM) {
+    filteredRpm = MAX_RPM;
+    if (rpmVelocity > 0) rpmVelocity = 0;
+  } else if (filteredRpm <= MIN_RPM) {
+    filteredRpm = MIN_RPM;
+    if (rpmVelocity < 0) rpmVelocity = 0;
+  }
+  
+  data.displayedRpm = (int)(filteredRpm + 0.5f);
 }
 
 float VehicleLogic::calculateMph(int rpm) {
@@ -2,6 +2,7 @@
 #define LOGIC_H
 
 #include <Arduino.h>
+#include "latency.h"
 #define MAX_RPM 12000
 #define MIN_RPM 0
 #define MAX_SPEED_MODES 3
@@ -11,7 +12,11 @@
 #define REAR_SPROCKET_TEETH 54.0f
 #define SIF_DATA_TIMEOUT 2000
 #define PYTHON_DATA_TIMEOUT 2000
-#define RPM_ANIMATION_SPEED 8  // Changed from 1 to 8 for faster animation
+#define RPM_FILTER_OMEGA 30.0f  // Needle response in rad/s (critically damped, within 2% in ~195ms)
+#define RPM_PREDICT_MAX_US 150000  // Never extrapolate the RPM trend further than this past a frame
+#define RPM_TREND_MAX_GAP_US 500000  // Frames further apart than this don't define a trend
+#define RPM_TREND_DECAY_US 150000  // After the predict window the extrapolation fades back to the last frame over this
+#define RPM_ANIMATION_MAX_STEP_US 100000  // Clamp for long loop stalls
 #define RPM_GREEN_THRESHOLD 4000
 #define RPM_YELLOW_THRESHOLD 6000
 #define RPM_RED_THRESHOLD 7000
@@ -33,6 +38,7 @@ struct VehicleData {
   bool usingSifData;
   float mph;
   int displayedRpm;
+  FrameStamps frame;
 };
 
 class VehicleLogic {
@@ -40,12 +46,19 @@ private:
   VehicleData data;
   unsigned long lastPythonData;
   int targetRpm;
+  float filteredRpm;
+  float rpmVelocity;    // RPM per second, needle state
+  float rpmTrend;       // RPM per microsecond between the last two frames
+  unsigned long lastFrameUs;
+  unsigned long lastAnimationUs;
+  
+  void setTargetRpm(int rpm);
   
 public:
   VehicleLogic();
   void init();
   void parsePythonData(String inputData);
-  void parseSifData(byte sifData[12]);
+  void parseSifData(byte sifData[12], uint64_t captureUs);
   void updateDataSource();
   void updateRpmAnimation();
   float calculateMph(int rpm);
@@ -4,15 +4,23 @@
 #include "USB.h"
 #include "ui.h"
 #include "logic.h"
+#include "latency.h"
+#include "aggregator.h"
+#include "dma_display.h"
 
 #define TFT_CS   12
 #define TFT_DC   13
 #define TFT_RST  14
+#define TFT_SCK  7
+#define TFT_MOSI 11
 #define SIF_PIN  4
 
-Adafruit_ST7789 tft = Adafruit_ST7789(TFT_CS, TFT_DC, TFT_RST);
+AsyncST7789 tft = AsyncST7789(TFT_CS, TFT_DC, TFT_RST);
+SpiDmaTransport displayTransport;
 VehicleLogic vehicleLogic;
 VehicleUI vehicleUI;
+LatencyTracker latencyTracker;
+TelemetryAggregator telemetryAggregator;
 
 volatile unsigned long lastTime;
 volatile unsigned long lastDuration = 0;
@@ -20,18 +28,22 @@ volatile byte lastCrc = 0;
 volatile byte data[12];
 volatile int bitIndex = -1;
 volatile bool newDataAvailable = false;
+volatile uint64_t frameCaptureUs = 0;
 
 unsigned long lastDataSent = 0;
 unsigned long lastDisplayUpdate = 0;
+unsigned long lastLatencyReport = 0;
+uint32_t displayFence = 0;
+bool displayFramePending = false;
+FrameStamps displayedFrame;
 unsigned long sifPacketCount = 0;
 bool debugMode = false;
 
 void IRAM_ATTR sifChange();
-void sendDataToLogger(byte rawSifData[12]);
+void sendDataToLogger(byte rawSifData[12], uint64_t timestampUs);
 
-void sendDataToLogger(byte rawSifData[12]) {
+void sendDataToLogger(byte rawSifData[12], uint64_t timestampUs) {
   VehicleData vehicleData = vehicleLogic.getVehicleData();
-  float timestamp = millis() / 1000.0;
   
   String powerState = "IDLE";
   if (vehicleData.regen) powerState = "REGEN";
@@ -41,7 +53,7 @@ void sendDataToLogger(byte rawSifData[12]) {
   float estPower = abs(vehicleData.current * vehicleData.voltage / 1000.0);
   int b2Direction = (vehicleData.rpm > 100) ? 1 : 0;
   
-  Serial.print(timestamp, 3);
+  Serial.print(timestampUs);
   Serial.print(",");
   
   for (int i = 0; i < 12; i++) {
@@ -77,19 +89,26 @@ void setup() {
   Serial.begin(115200);
   delay(1000);
   
-  SPI.begin(7, -1, 11, -1);
+  SPI.begin(TFT_SCK, -1, TFT_MOSI, -1);
   tft.init(240, 320);
   tft.setRotation(3);
   
   vehicleLogic.init();
   vehicleUI.init(&tft);
   vehicleUI.drawStartupScreen();
+  // Panel setup and the splash (which waits on screen) go through Adafruit's
+  // blocking SPI; from here on the bus belongs to the DMA transport.
+  bool dmaDisplay = displayTransport.begin(TFT_SCK, TFT_MOSI, TFT_CS, TFT_DC);
+  if (dmaDisplay) tft.attachTransport(&displayTransport);
   
   pinMode(SIF_PIN, INPUT);
   lastTime = micros();
   attachInterrupt(digitalPinToInterrupt(SIF_PIN), sifChange, CHANGE);
   
-  Serial.println("Timestamp,Byte0,Byte1,Byte2,Byte3,Byte4,Byte5,Byte6,Byte7,Byte8,Byte9,Byte10,Byte11,Battery,LoadVoltage,RPM,SpeedMode,Reverse,Brake,Regen,PowerState,B2Direction,EstPower");
+  Serial.println("TimestampUs,Byte0,Byte1,Byte2,Byte3,Byte4,Byte5,Byte6,Byte7,Byte8,Byte9,Byte10,Byte11,Battery,LoadVoltage,RPM,SpeedMode,Reverse,Brake,Regen,PowerState,B2Direction,EstPower");
+  Serial.println("# LAT,ParseP50Us,ParseP99Us,PublishP50Us,PublishP99Us,DrawP50Us,DrawP99Us,GlassP50Us,GlassP99Us");
+  telemetryAggregator.init();
+  if (!dmaDisplay) Serial.println("# Display DMA unavailable, drawing synchronously");
   Serial.println("# ESP32-S2 SIF Reader Started");
 }
 
@@ -105,10 +124,16 @@ void loop() {
     for (int i = 0; i < 12; i++) {
       localData[i] = data[i];
     }
+    uint64_t captureUs = frameCaptureUs;
     interrupts();
     
-    vehicleLogic.parseSifData(localData);
-    sendDataToLogger(localData);
+    vehicleLogic.parseSifData(localData, captureUs);
+    VehicleData parsed = vehicleLogic.getVehicleData();
+    latencyTracker.recordParsed(parsed.frame);
+    telemetryAggregator.addFrame(parsed);
+    if (telemetryAggregator.isRawEnabled()) {
+      sendDataToLogger(localData, captureUs);
+    }
     lastDataSent = currentMillis;
   }
   
@@ -133,14 +158,35 @@ void loop() {
     } else if (command.equals("SIF_ON")) {
       vehicleLogic.setUsingSifData(true);
       Serial.println("# SIF enabled");
+    } else if (command.equals("GAUGE_ARC")) {
+      vehicleUI.setGaugeStyle(GAUGE_STYLE_ARC);
+      Serial.println("# Gauge style: arc");
+    } else if (command.equals("GAUGE_BARS")) {
+      vehicleUI.setGaugeStyle(GAUGE_STYLE_BARS);
+      Serial.println("# Gauge style: bars");
+    } else if (command.equals("GAUGE_BENCH")) {
+      vehicleUI.benchmarkGauge();
+    } else if (command.equals("DISPLAY_STATS")) {
+      tft.printStats();
+    } else if (command.equals("LATENCY")) {
+      latencyTracker.printReport();
+    } else if (command.equals("AGG_TIERS")) {
+      telemetryAggregator.printConfig();
+    } else if (command.startsWith("AGG_TIERS ")) {
+      if (telemetryAggregator.configure(command.substring(10))) {
+        telemetryAggregator.printConfig();
+      } else {
+        Serial.println("# AGG_TIERS expects up to 4 periods in ms, e.g. AGG_TIERS 0,100,1000");
+      }
     } else {
       vehicleLogic.parsePythonData(command);
     }
   }
   
   vehicleLogic.updateDataSource();
+  telemetryAggregator.update(currentMillis);
   
-  if (currentMillis - lastDataSent > 200) {
+  if (telemetryAggregator.isRawEnabled() && currentMillis - lastDataSent > 200) {
     byte localData[12];
     noInterrupts();
     for (int i = 0; i < 12; i++) {
@@ -148,16 +194,37 @@ void loop() {
     }
     interrupts();
     
-    sendDataToLogger(localData);
+    sendDataToLogger(localData, latencyNowUs());
     lastDataSent = currentMillis;
   }
   
+  if (displayFramePending && tft.isFrameComplete(displayFence)) {
+    displayedFrame.stageUs[LATENCY_SPI_DONE] = tft.frameCompletedUs();
+    latencyTracker.recordDrawn(displayedFrame);
+    displayFramePending = false;
+  }
+  
   if (currentMillis - lastDisplayUpdate > 50) {
     VehicleData vehicleData = vehicleLogic.getVehicleData();
+    vehicleData.frame.stageUs[LATENCY_DRAW_START] = latencyNowUs();
     vehicleUI.updateDisplay(vehicleData);
+    // Returns once the frame is queued; SPI_DONE is stamped when its fence
+    // completes. A frame still on the bus when the next one is queued, or one
+    // that drew nothing (same fence back), isn't sampled.
+    uint32_t fence = tft.endFrame();
+    if (fence != displayFence) {
+      displayedFrame = vehicleData.frame;
+      displayFramePending = true;
+    }
+    displayFence = fence;
     lastDisplayUpdate = currentMillis;
   }
   
+  if (currentMillis - lastLatencyReport >= LATENCY_REPORT_MS) {
+    latencyTracker.sendTelemetry();
+    lastLatencyReport = currentMillis;
+  }
+  
   if (debugMode && currentMillis % 1000 == 0) {
     Serial.print("# DEBUG - Packets: ");
     Serial.print(sifPacketCount);
@@ -199,6 +266,7 @@ void IRAM_ATTR sifChange() {
           
           if (crc == data[11] && crc != lastCrc) {
             lastCrc = crc;
+            frameCaptureUs = esp_timer_get_time();
             newDataAvailable = true;
           }
         }
@@ -1,4 +1,5 @@
 #include "ui.h"
+#include "arc_gauge.h"
 #include <Fonts/FreeSerif9pt7b.h>
 VehicleUI::VehicleUI() {
   display = nullptr;
@@ -7,6 +8,11 @@ VehicleUI::VehicleUI() {
   lastRegen = false;
   lastReverse = false;
   lastActiveSegments = -1;
+  lastArcSegments = -1;
+  gaugeStyle = GAUGE_STYLE_BARS;
+  gaugeUpdates = 0;
+  gaugePixels = 0;
+  gaugeMicros = 0;
   lastBattery = -1;
   lastVoltage = -1;
   lastCurrent = -999;
@@ -17,7 +23,7 @@ VehicleUI::VehicleUI() {
   revLimiterBorderShown = false;
 }
 
-void VehicleUI::init(Adafruit_ST7789* tft) {
+void VehicleUI::init(AsyncST7789* tft) {
   display = tft;
   Serial.println("Vehicle UI initialized");
 }
@@ -168,7 +174,11 @@ void VehicleUI::drawReverse(bool reverseMode) {
   if (reverseMode != wasInReverse) {
     if (reverseMode) {
       // Clear the entire center area when entering reverse
-      display->fillRect(35, 35, 250, 140, COLOR_BACKGROUND);
+      if (gaugeStyle == GAUGE_STYLE_ARC) {
+        clearGaugeArea();
+      } else {
+        display->fillRect(35, 35, 250, 140, COLOR_BACKGROUND);
+      }
       
       // Draw REVERSE text
       display->setTextColor(COLOR_GAUGE_RED);
@@ -190,6 +200,7 @@ void VehicleUI::drawMphGauge(float mph, int displayedRpm, bool reverseMode) {
     // Only clear the center area, NOT the side gauges
     display->fillRect(35, 35, 250, 140, COLOR_BACKGROUND);
     lastActiveSegments = -1;
+    lastArcSegments = -1;
     
     // Force redraw of all UI elements by resetting their "last" values
     lastSpeedMode = 255;  // Force speed mode redraw
@@ -204,43 +215,195 @@ void VehicleUI::drawMphGauge(float mph, int displayedRpm, bool reverseMode) {
   
   if (reverseMode) return;
   
-  int activeSegments = map(displayedRpm, 0, MAX_RPM, 0, 36);
-  if (activeSegments != lastActiveSegments) {
-    display->fillRect(0, 10, 30, 191, COLOR_BACKGROUND);
-    display->fillRect(290, 10, 30, 191, COLOR_BACKGROUND);
-    
-    uint16_t segColor = getGaugeColor(displayedRpm);
-    for (int i = 0; i < activeSegments; i++) {
-      int barHeight = 4;
-      int barSpacing = 1;
-      int totalBarHeight = barHeight + barSpacing;
-      int yPos = 190 - (i * totalBarHeight);
-      display->fillRect(2, yPos - barHeight, 26, barHeight, segColor);
-      display->fillRect(292, yPos - barHeight, 26, barHeight, segColor);
-    }
-    
-    lastActiveSegments = activeSegments;
+  unsigned long gaugeStart = micros();
+  long pixels = (gaugeStyle == GAUGE_STYLE_ARC) ? drawArcGauge(displayedRpm) : drawBarGauge(displayedRpm);
+  if (pixels > 0) {
+    gaugeUpdates++;
+    gaugePixels += pixels;
+    gaugeMicros += micros() - gaugeStart;
   }
+  
   int displayMph = (int)mph;
   if (abs(displayMph - lastMphShown) > 1) {
-    display->fillRect(50, 45, 220, 100, COLOR_BACKGROUND);
+    drawMphReadout(displayMph, displayedRpm);
+    lastMphShown = displayMph;
+  }
+}
+
+// Returns the number of pixels written, 0 when nothing changed.
+long VehicleUI::drawBarGauge(int displayedRpm) {
+  int activeSegments = map(displayedRpm, 0, MAX_RPM, 0, 36);
+  if (activeSegments == lastActiveSegments) return 0;
+  
+  display->fillRect(0, 10, 30, 191, COLOR_BACKGROUND);
+  display->fillRect(290, 10, 30, 191, COLOR_BACKGROUND);
+  
+  uint16_t segColor = getGaugeColor(displayedRpm);
+  for (int i = 0; i < activeSegments; i++) {
+    int barHeight = 4;
+    int barSpacing = 1;
+    int totalBarHeight = barHeight + barSpacing;
+    int yPos = 190 - (i * totalBarHeight);
+    display->fillRect(2, yPos - barHeight, 26, barHeight, segColor);
+    display->fillRect(292, yPos - barHeight, 26, barHeight, segColor);
+  }
+  
+  lastActiveSegments = activeSegments;
+  return 2L * 30 * 191 + activeSegments * 2L * 26 * 4;
+}
+
+// Only the segments between the old and new reading change state, so only
+// those are redrawn. Returns the number of pixels written.
+long VehicleUI::drawArcGauge(int displayedRpm) {
+  int activeSegments = map(displayedRpm, 0, MAX_RPM, 0, GAUGE_SEGMENTS);
+  if (activeSegments == lastArcSegments) return 0;
+  
+  int from = 0;
+  int to = GAUGE_SEGMENTS;
+  if (lastArcSegments >= 0) {
+    from = min(activeSegments, lastArcSegments);
+    to = max(activeSegments, lastArcSegments);
+  }
+  
+  long pixels = 0;
+  display->startWrite();
+  for (int i = from; i < to; i++) {
+    pixels += drawArcSegment(i, getArcSegmentColor(i, activeSegments));
+  }
+  display->endWrite();
+  
+  lastArcSegments = activeSegments;
+  return pixels;
+}
+
+long VehicleUI::drawArcSegment(int segment, uint16_t color) {
+  for (int i = ARC_SPANS.first[segment]; i < ARC_SPANS.first[segment + 1]; i++) {
+    const ArcSpan& span = ARC_SPANS.spans[i];
+    display->writeFastHLine(span.x, span.y, span.w, color);
+  }
+  return ARC_SPANS.pixels[segment];
+}
+
+void VehicleUI::drawMphReadout(int displayMph, int displayedRpm) {
+  if (gaugeStyle == GAUGE_STYLE_ARC) {
+    display->fillRect(ARC_MPH_X, ARC_MPH_Y, ARC_MPH_WIDTH, ARC_MPH_HEIGHT, COLOR_BACKGROUND);
     
+    int digits = displayMph >= 100 ? 3 : (displayMph >= 10 ? 2 : 1);
     display->setTextColor(COLOR_TEXT_PRIMARY);
-    display->setTextSize(8);
-    display->setCursor(80, 45);
+    display->setTextSize(6);
+    display->setCursor(ARC_GAUGE_CENTER_X - digits * 18, ARC_MPH_Y + 2);
     display->print(displayMph);
     
-    display->setTextSize(3);
-    display->setCursor(200, 85);
-    display->print("MPH");
     display->setTextSize(2);
+    display->setCursor(ARC_GAUGE_CENTER_X - 18, ARC_MPH_Y + 52);
+    display->print("MPH");
     display->setTextColor(COLOR_TEXT_SECONDARY);
-    display->setCursor(120, 130);
+    display->setCursor(ARC_MPH_X + 8, ARC_MPH_Y + 74);
     display->print(displayedRpm);
     display->print(" RPM");
+    return;
+  }
+  
+  display->fillRect(50, 45, 220, 100, COLOR_BACKGROUND);
+  
+  display->setTextColor(COLOR_TEXT_PRIMARY);
+  display->setTextSize(8);
+  display->setCursor(80, 45);
+  display->print(displayMph);
+  
+  display->setTextSize(3);
+  display->setCursor(200, 85);
+  display->print("MPH");
+  display->setTextSize(2);
+  display->setTextColor(COLOR_TEXT_SECONDARY);
+  display->setCursor(120, 130);
+  display->print(displayedRpm);
+  display->print(" RPM");
+}
+
+// Clears everything either gauge style can draw on, including the status
+// indicators the arc's lower ends sit beside.
+void VehicleUI::clearGaugeArea() {
+  display->fillRect(0, 10, 30, 191, COLOR_BACKGROUND);
+  display->fillRect(290, 10, 30, 191, COLOR_BACKGROUND);
+  display->fillRect(35, 32, 250, 165, COLOR_BACKGROUND);
+  lastBrake = !lastBrake;
+  lastRegen = !lastRegen;
+}
+
+void VehicleUI::setGaugeStyle(GaugeStyle style) {
+  if (style == gaugeStyle) return;
+  gaugeStyle = style;
+  if (!display) return;
+  
+  clearGaugeArea();
+  lastActiveSegments = -1;
+  lastArcSegments = -1;
+  lastMphShown = -999;
+  wasInReverse = false;  // Redraw REVERSE too if we're in it
+}
+
+GaugeStyle VehicleUI::getGaugeStyle() {
+  return gaugeStyle;
+}
+
+// Sweeps each gauge style from 0 to MAX_RPM and back and reports the cost of
+// an update, alongside the running average from normal operation.
+void VehicleUI::benchmarkGauge() {
+  if (!display) return;
+  
+  Serial.print("# GAUGE live: ");
+  Serial.print(gaugeUpdates);
+  Serial.print(" updates, ");
+  Serial.print(gaugeUpdates ? gaugePixels / gaugeUpdates : 0);
+  Serial.print(" px/update, ");
+  Serial.print(gaugeUpdates ? gaugeMicros / gaugeUpdates : 0);
+  Serial.println(" us/update to queue");
+  
+  GaugeStyle savedStyle = gaugeStyle;
+  const GaugeStyle styles[] = {GAUGE_STYLE_BARS, GAUGE_STYLE_ARC};
+  for (GaugeStyle style : styles) {
+    setGaugeStyle(style);
+    if (style == GAUGE_STYLE_ARC) drawArcGauge(0);
+    else drawBarGauge(0);
     
-    lastMphShown = displayMph;
+    display->waitForFrame(display->endFrame());
+    
+    // Each update is its own frame: time to queue the draw calls, then time
+    // until its fence says the last pixel is out. Without DMA both are the
+    // blocking draw time.
+    unsigned long updates = 0;
+    unsigned long pixels = 0;
+    unsigned long queueMicros = 0;
+    unsigned long glassMicros = 0;
+    for (int step = 1; step <= GAUGE_BENCH_STEPS; step++) {
+      int half = GAUGE_BENCH_STEPS / 2;
+      int rpm = (long)(step <= half ? step : GAUGE_BENCH_STEPS - step) * MAX_RPM / half;
+      unsigned long start = micros();
+      long px = (style == GAUGE_STYLE_ARC) ? drawArcGauge(rpm) : drawBarGauge(rpm);
+      unsigned long queued = micros();
+      display->waitForFrame(display->endFrame());
+      if (px > 0) {
+        updates++;
+        pixels += px;
+        queueMicros += queued - start;
+        glassMicros += micros() - start;
+      }
+    }
+    
+    Serial.print("# GAUGE_BENCH ");
+    Serial.print(style == GAUGE_STYLE_ARC ? "arc" : "bars");
+    Serial.print(": ");
+    Serial.print(updates);
+    Serial.print(" updates, ");
+    Serial.print(updates ? pixels / updates : 0);
+    Serial.print(" px/update, ");
+    Serial.print(updates ? queueMicros / updates : 0);
+    Serial.print(" us/update to queue, ");
+    Serial.print(updates ? glassMicros / updates : 0);
+    Serial.println(" us/update to glass");
   }
+  setGaugeStyle(savedStyle);
 }
 
 void VehicleUI::updateBottomInfo(float battery, float voltage, int current) {
@@ -323,6 +486,11 @@ uint16_t VehicleUI::getGaugeColor(int rpm) {
   else return COLOR_GAUGE_GREEN;
 }
 
+uint16_t VehicleUI::getArcSegmentColor(int segment, int activeSegments) {
+  if (segment >= activeSegments) return COLOR_ARCH_OUTLINE;
+  return getGaugeColor((long)segment * MAX_RPM / GAUGE_SEGMENTS);
+}
+
 uint16_t VehicleUI::getBatteryColor(float battery) {
   if (battery < BATTERY_LOW_THRESHOLD) return COLOR_BATTERY_LOW;
   else if (battery < BATTERY_MEDIUM_THRESHOLD) return COLOR_BATTERY_MED;
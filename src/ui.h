@@ -4,6 +4,7 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_ST7789.h>
 #include "logic.h"
+#include "dma_display.h"
 #define SCREEN_WIDTH 320
 #define SCREEN_HEIGHT 240
 #define MODE_Y 15
@@ -16,6 +17,17 @@
 #define GAUGE_RADIUS 120
 #define MPH_DISPLAY_Y 140
 #define GAUGE_SEGMENTS 23
+#define ARC_GAUGE_CENTER_X GAUGE_CENTER_X
+#define ARC_GAUGE_CENTER_Y (GAUGE_CENTER_Y + 65)  // Dropped so the arc top clears the mode line
+#define ARC_GAUGE_OUTER_RADIUS GAUGE_RADIUS
+#define ARC_GAUGE_INNER_RADIUS (GAUGE_RADIUS - 16)
+#define ARC_GAUGE_START_DEG 200  // Zero RPM end, counter-clockwise from 3 o'clock
+#define ARC_GAUGE_SWEEP_DEG 220
+#define ARC_GAUGE_GAP_DEG 1.5
+#define ARC_MPH_X 96  // MPH/RPM readout box inside the arc
+#define ARC_MPH_Y 76
+#define ARC_MPH_WIDTH 128
+#define ARC_MPH_HEIGHT 96
 #define STATUS_AREA_Y 175  // Moved down
 #define STATUS_AREA_HEIGHT 15  // Made thinner
 #define REV_LIMITER_FLASH_RATE 250  // Flash rate in milliseconds
@@ -37,13 +49,24 @@
 #define COLOR_CURRENT_HIGH ST77XX_RED
 #define COLOR_CURRENT_NORMAL ST77XX_WHITE
 #define COLOR_ARCH_OUTLINE 0x4208
+#define GAUGE_BENCH_STEPS 200
+
+enum GaugeStyle {
+  GAUGE_STYLE_BARS,
+  GAUGE_STYLE_ARC
+};
 
 class VehicleUI {
 private:
-  Adafruit_ST7789* display;
+  AsyncST7789* display;
   byte lastSpeedMode;
   bool lastBrake, lastRegen, lastReverse;
   int lastActiveSegments;
+  int lastArcSegments;
+  GaugeStyle gaugeStyle;
+  unsigned long gaugeUpdates;
+  unsigned long gaugePixels;
+  unsigned long gaugeMicros;  // Time to draw (queue, with DMA) the gauge, not to get it on the glass
   float lastBattery;
   float lastVoltage;
   int lastCurrent;
@@ -55,9 +78,12 @@ private:
   
 public:
   VehicleUI();
-  void init(Adafruit_ST7789* tft);
+  void init(AsyncST7789* tft);
   void drawStartupScreen();
   void updateDisplay(VehicleData data);
+  void setGaugeStyle(GaugeStyle style);
+  GaugeStyle getGaugeStyle();
+  void benchmarkGauge();
   
 private:
   void drawStaticElements();
@@ -67,10 +93,16 @@ private:
   void updateStatusIndicators(bool brake, bool regen, bool reverseMode);
   void drawReverse(bool reverseMode);
   void drawMphGauge(float mph, int displayedRpm, bool reverseMode);
+  long drawBarGauge(int displayedRpm);
+  long drawArcGauge(int displayedRpm);
+  long drawArcSegment(int segment, uint16_t color);
+  void drawMphReadout(int displayMph, int displayedRpm);
+  void clearGaugeArea();
   void updateBottomInfo(float battery, float voltage, int current);
   void updateRevLimiterWarning(int rpm);
   void drawRevLimiterBorder(bool show);
   uint16_t getGaugeColor(int rpm);
+  uint16_t getArcSegmentColor(int segment, int activeSegments);
   uint16_t getBatteryColor(float battery);
   uint16_t getCurrentColor(int current);
   uint16_t getSpeedModeColor(byte speedMode);
@@ -1,41 +1,111 @@
 import serial
+import sys
 import matplotlib.pyplot as plt
 import matplotlib.animation as animation
 from matplotlib.patches import Rectangle
 import matplotlib
-matplotlib.use('TkAgg')  # Ensure compatibility with tkinter
+matplotlib.use('Agg' if '--bench' in sys.argv else 'TkAgg')  # Ensure compatibility with tkinter
 import pandas as pd
 import numpy as np
-from collections import deque
 import threading
 import time
-import queue
 import tkinter as tk
 from tkinter import ttk, messagebox, Scale
-import sys
+import os
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'tools', 'sif_ingest'))
+POWER_STATES = ['IDLE', 'COAST', 'LOAD', 'REGEN']
+POWER_STATE_CODES = {name: code for code, name in enumerate(POWER_STATES)}
+DISPLAY_INTERVAL_MS = 100  # Plot and label refresh period
+PLOT_WINDOW_S = 30.0       # Seconds of history shown on the plots
+TIME_RESET_S = 1.0         # Device time stepping back further than this means the dash restarted
+
+class SampleRing:
+    """Preallocated columnar ring buffer with a single write index.
+
+    Each sample is stored twice (at i and i + capacity), so the newest
+    `capacity` samples are always one contiguous, time-ordered slice and
+    plotting never copies or reorders the history.
+    """
+    COLUMNS = ('timestamp', 'battery', 'rpm', 'load_voltage', 'power_state',
+               'est_power', 'b2_direction', 'byte0', 'byte1', 'byte2', 'byte3')
+
+    def __init__(self, capacity):
+        self.capacity = capacity
+        self.columns = {name: i for i, name in enumerate(self.COLUMNS)}
+        self.data = np.zeros((len(self.COLUMNS), 2 * capacity))
+        self.write_index = 0
+        self.last_time = -np.inf
+        self.time_offset = 0.0
+
+    def _monotonic(self, times):
+        """Keep the timestamp column non-decreasing so the plot window can be
+        found with a binary search. Resend rows are stamped after the frames
+        around them were captured, so small steps back are clamped; a large
+        one is a dash restart, and the new clock is offset to carry on from
+        the last sample."""
+        times = np.asarray(times, dtype=float) + self.time_offset
+        steps = np.diff(np.concatenate(([self.last_time], times)))
+        for i in np.flatnonzero(steps < -TIME_RESET_S):
+            shift = (self.last_time if i == 0 else times[i - 1]) - times[i]
+            times[i:] += shift
+            self.time_offset += shift
+        times = np.maximum.accumulate(np.concatenate(([self.last_time], times)))[1:]
+        self.last_time = times[-1]
+        return times
+
+    def append(self, values):
+        # Scalar version of _monotonic(); this runs once per serial row
+        values = list(values)
+        t = values[0] + self.time_offset
+        if t < self.last_time - TIME_RESET_S:
+            self.time_offset += self.last_time - t
+            t = self.last_time
+        values[0] = self.last_time = max(t, self.last_time)
+        i = self.write_index % self.capacity
+        self.data[:, i] = values
+        self.data[:, i + self.capacity] = values
+        self.write_index += 1
+
+    def extend(self, block):
+        """Append a (len(COLUMNS), n) block of samples."""
+        if block.shape[1] == 0:
+            return
+        block = np.array(block, dtype=float)
+        block[0] = self._monotonic(block[0])
+        n = block.shape[1]
+        if n > self.capacity:
+            self.write_index += n - self.capacity
+            block = block[:, -self.capacity:]
+            n = self.capacity
+        positions = (self.write_index + np.arange(n)) % self.capacity
+        self.data[:, positions] = block
+        self.data[:, positions + self.capacity] = block
+        self.write_index += n
+
+    def view(self, name, write_index=None):
+        """Newest samples of one column, oldest first (a view, not a copy)."""
+        w = self.write_index if write_index is None else write_index
+        row = self.data[self.columns[name]]
+        if w <= self.capacity:
+            return row[:w]
+        start = w % self.capacity
+        return row[start:start + self.capacity]
 
 class SIFDashboard:
-    def __init__(self):
+    def __init__(self, headless=False):
         self.serial_port = None
+        self.ring = None
         self.serial_thread = None
         self.running = False
+        self.headless = headless
         
-        self.max_points = 1000
-        self.data_queue = queue.Queue()
-        
-        self.timestamps = deque(maxlen=self.max_points)
-        self.battery_data = deque(maxlen=self.max_points)
-        self.rpm_data = deque(maxlen=self.max_points)
-        self.load_voltage_data = deque(maxlen=self.max_points)
-        self.power_state_data = deque(maxlen=self.max_points)
-        self.b2_direction = deque(maxlen=self.max_points)
-        self.est_power = deque(maxlen=self.max_points)
-        
-        # New: Temperature candidate data
-        self.byte0_data = deque(maxlen=self.max_points)
-        self.byte1_data = deque(maxlen=self.max_points)
-        self.byte2_data = deque(maxlen=self.max_points)
-        self.byte3_data = deque(maxlen=self.max_points)
+        self.max_points = 16384
+        self.samples = SampleRing(self.max_points)
+        self.latest_sample = None
+        self.plotted_index = 0
+        self.labels_index = 0
+        self.latency_shown = None
         
         self.current_values = {
             'battery': 0, 'rpm': 0, 'load_voltage': 0, 'speed_mode': 0,
@@ -57,13 +127,13 @@ class SIFDashboard:
         }
         
         self.raw_bytes = [0] * 12
-        self.setup_gui()
+        self.latency_us = {}
+        self.setup_colors()
+        if not headless:
+            self.setup_gui()
         self.setup_plots()
         
-    def setup_gui(self):
-        self.root = tk.Tk()
-        self.root.title("SIF Vehicle Data Dashboard with Temperature Analysis")
-        self.root.geometry("1800x1000")
+    def setup_colors(self):
         self.bg_color = '#1e1e1e'
         self.fg_color = '#ffffff'
         self.frame_bg = '#2d2d2d'
@@ -74,6 +144,11 @@ class SIFDashboard:
         self.success_color = '#4CAF50'
         self.error_color = '#f44336'
         self.warning_color = '#ff9800'
+        
+    def setup_gui(self):
+        self.root = tk.Tk()
+        self.root.title("SIF Vehicle Data Dashboard with Temperature Analysis")
+        self.root.geometry("1800x1000")
         self.root.configure(bg=self.bg_color)
         style = ttk.Style()
         style.theme_use('clam')
@@ -109,6 +184,9 @@ class SIFDashboard:
         self.status_label = ttk.Label(control_frame, text="Disconnected", foreground=self.error_color)
         self.status_label.pack(side=tk.LEFT, padx=10)
         
+        self.latency_label = ttk.Label(control_frame, text="Frame-to-glass: --")
+        self.latency_label.pack(side=tk.LEFT, padx=10)
+        
         data_frame = ttk.LabelFrame(left_frame, text="Current Values", padding=10)
         data_frame.pack(fill=tk.X, padx=10, pady=5)
         
@@ -283,6 +361,7 @@ class SIFDashboard:
         self.format_label.pack()
         self.update_format_display()
         self.auto_send_timer()
+        self.refresh_labels()
     
     def convert_temp_candidates(self, raw_byte):
         """Convert raw byte to potential temperature values using common automotive methods"""
@@ -340,6 +419,9 @@ class SIFDashboard:
         self.axes[1,2].grid(True, alpha=0.3)
         self.axes[1,2].set_facecolor(self.frame_bg)
         for ax in self.axes.flat:
+            # Fixed limits (x is seconds before the newest sample) so blitting
+            # never has to redraw the axes
+            ax.set_xlim(-PLOT_WINDOW_S, 0)
             ax.tick_params(colors=self.fg_color)
             ax.spines['bottom'].set_color(self.button_bg)
             ax.spines['top'].set_color(self.button_bg)
@@ -354,6 +436,7 @@ class SIFDashboard:
             'est_power': self.axes[1,1].plot([], [], '#FF9800', linewidth=2)[0],     # Orange
             'direction': self.axes[1,2].plot([], [], '#00BCD4', linewidth=2)[0]      # Cyan
         }
+        self.line_artists = list(self.lines.values())
         
         plt.tight_layout()
     
@@ -417,44 +500,62 @@ class SIFDashboard:
     
     def connect_serial(self):
         try:
-            self.serial_port = serial.Serial(self.port_var.get(), 115200, timeout=1)
+            port = self.port_var.get()
             self.running = True
-            self.serial_thread = threading.Thread(target=self.read_serial_data, daemon=True)
+            if port.startswith("ring:"):
+                # e.g. "ring:sif_ring" - share the port with other readers via sif_ingest
+                from sif_ring import SifRing
+                self.ring = SifRing(port[len("ring:"):])
+                self.serial_thread = threading.Thread(target=self.read_ring_data, daemon=True)
+            else:
+                self.serial_port = serial.Serial(port, 115200, timeout=1)
+                self.serial_thread = threading.Thread(target=self.read_serial_data, daemon=True)
             self.serial_thread.start()
             
             self.connect_btn.config(text="Disconnect")
             self.status_label.config(text="Connected", foreground=self.success_color)
             
-            self.ani = animation.FuncAnimation(self.fig, self.update_plots, interval=100, blit=False)
+            self.ani = animation.FuncAnimation(self.fig, self.update_plots, interval=DISPLAY_INTERVAL_MS,
+                                               blit=True, cache_frame_data=False)
             if hasattr(self.fig.canvas.manager, 'window'):
                 self.fig.canvas.manager.window.wm_attributes('-topmost', False)
             plt.show()
             
         except Exception as e:
+            self.running = False
             messagebox.showerror("Connection Error", f"Failed to connect: {str(e)}")
     
     def disconnect_serial(self):
         self.running = False
         if self.serial_port:
             self.serial_port.close()
+        if self.ring:
+            self.ring.close()
+            self.ring = None
         
         self.connect_btn.config(text="Connect")
         self.status_label.config(text="Disconnected", foreground=self.error_color)
     
     def read_serial_data(self):
         header_found = False
+        pending = b''
         
         while self.running:
             try:
-                if self.serial_port and self.serial_port.in_waiting:
-                    line = self.serial_port.readline().decode('utf-8').strip()
+                # Blocks for up to the port timeout instead of spinning on in_waiting
+                pending += self.serial_port.read(self.serial_port.in_waiting or 1)
+                *lines, pending = pending.split(b'\n')
+                for raw in lines:
+                    line = raw.decode('utf-8', errors='replace').strip()
                     
                     if not header_found:
                         if line.startswith("Timestamp"):
                             header_found = True
                         continue
                     
-                    if line and not line.startswith("SIF") and not line.startswith("Waiting"):
+                    if line.startswith("LAT,"):
+                        self.parse_latency_line(line)
+                    elif line and not line.startswith(("SIF", "Waiting", "#", "AGG,")):
                         self.parse_data_line(line)
                         
             except Exception as e:
@@ -464,8 +565,9 @@ class SIFDashboard:
     def parse_data_line(self, line):
         try:
             parts = line.split(',')
-            if len(parts) >= 25:  
-                timestamp = float(parts[0])
+            if len(parts) >= 23:
+                # Firmware stamps rows in microseconds; older builds sent seconds
+                timestamp = float(parts[0]) if '.' in parts[0] else int(parts[0]) / 1e6
                 raw_bytes = [int(parts[i]) for i in range(1, 13)]
                 battery = int(parts[13])
                 load_voltage = int(parts[14])
@@ -478,46 +580,90 @@ class SIFDashboard:
                 b2_direction = int(parts[21])
                 est_power = float(parts[22])
 
-                # NEW: Extract temperature candidate bytes
-                byte0, byte1, byte2, byte3 = raw_bytes[0], raw_bytes[1], raw_bytes[2], raw_bytes[3]
-
-                data_point = {
-                    'timestamp': timestamp,
-                    'raw_bytes': raw_bytes,
-                    'battery': battery,
-                    'load_voltage': load_voltage,
-                    'rpm': rpm,
-                    'speed_mode': speed_mode,
-                    'reverse': reverse,
-                    'brake': brake,
-                    'regen': regen,
-                    'power_state': power_state,
-                    'b2_direction': b2_direction,
-                    'est_power': est_power,
-                    # NEW: Temperature candidates
-                    'byte0_raw': byte0,
-                    'byte1_raw': byte1,
-                    'byte2_raw': byte2,
-                    'byte3_raw': byte3,
-                    'byte0_temp_direct': byte0,
-                    'byte1_temp_direct': byte1,
-                    'byte2_temp_direct': byte2,
-                    'byte3_temp_direct': byte3,
-                    'byte0_temp_offset': byte0 - 40,
-                    'byte1_temp_offset': byte1 - 40,
-                    'byte2_temp_offset': byte2 - 40,
-                    'byte3_temp_offset': byte3 - 40,
-                    'byte0_temp_scaled': (byte0 * 0.5) - 40,
-                    'byte1_temp_scaled': (byte1 * 0.5) - 40,
-                    'byte2_temp_scaled': (byte2 * 0.5) - 40,
-                    'byte3_temp_scaled': (byte3 * 0.5) - 40
-                }
-                
-                self.data_queue.put(data_point)
+                self.samples.append((timestamp, battery, rpm, load_voltage,
+                                     POWER_STATE_CODES.get(power_state, 0), est_power, b2_direction,
+                                     raw_bytes[0], raw_bytes[1], raw_bytes[2], raw_bytes[3]))
+                # Labels only need the newest sample; they're refreshed at the display rate
+                self.latest_sample = (timestamp, raw_bytes, battery, load_voltage, rpm, speed_mode,
+                                      reverse, brake, regen, power_state, b2_direction, est_power)
                 
         except Exception as e:
             print(f"Parse error: {e}")
     
+    def parse_latency_line(self, line):
+        # LAT,ParseP50,ParseP99,PublishP50,PublishP99,DrawP50,DrawP99,GlassP50,GlassP99 (us)
+        try:
+            values = [int(v) for v in line.split(',')[1:9]]
+            self.latency_us = dict(zip(['parse', 'publish', 'draw', 'glass'],
+                                       zip(values[0::2], values[1::2])))
+        except ValueError as e:
+            print(f"Latency parse error: {e}")
+    
+    def update_latency_label(self):
+        p50, p99 = self.latency_us['glass']
+        self.latency_label.config(text=f"Frame-to-glass: p50 {p50 / 1000:.1f} ms, p99 {p99 / 1000:.1f} ms")
+    
+    def build_data_point(self, timestamp, raw_bytes, battery, load_voltage, rpm, speed_mode,
+                         reverse, brake, regen, power_state, b2_direction, est_power):
+        # NEW: Extract temperature candidate bytes
+        byte0, byte1, byte2, byte3 = raw_bytes[0], raw_bytes[1], raw_bytes[2], raw_bytes[3]
+
+        return {
+            'timestamp': timestamp,
+            'raw_bytes': raw_bytes,
+            'battery': battery,
+            'load_voltage': load_voltage,
+            'rpm': rpm,
+            'speed_mode': speed_mode,
+            'reverse': reverse,
+            'brake': brake,
+            'regen': regen,
+            'power_state': power_state,
+            'b2_direction': b2_direction,
+            'est_power': est_power,
+            # NEW: Temperature candidates
+            'byte0_raw': byte0,
+            'byte1_raw': byte1,
+            'byte2_raw': byte2,
+            'byte3_raw': byte3,
+            'byte0_temp_direct': byte0,
+            'byte1_temp_direct': byte1,
+            'byte2_temp_direct': byte2,
+            'byte3_temp_direct': byte3,
+            'byte0_temp_offset': byte0 - 40,
+            'byte1_temp_offset': byte1 - 40,
+            'byte2_temp_offset': byte2 - 40,
+            'byte3_temp_offset': byte3 - 40,
+            'byte0_temp_scaled': (byte0 * 0.5) - 40,
+            'byte1_temp_scaled': (byte1 * 0.5) - 40,
+            'byte2_temp_scaled': (byte2 * 0.5) - 40,
+            'byte3_temp_scaled': (byte3 * 0.5) - 40
+        }
+    
+    def read_ring_data(self):
+        # Attached to a running sif_ingest daemon instead of owning the port.
+        while self.running:
+            try:
+                for batch in self.ring.poll():
+                    if len(batch) == 0:
+                        continue
+                    raw = batch['raw']
+                    self.samples.extend(np.vstack((
+                        batch['device_time_us'] / 1e6, batch['battery'], batch['rpm'],
+                        batch['load_voltage'], batch['power_state'], batch['est_power'],
+                        batch['b2_direction'], raw[:, 0], raw[:, 1], raw[:, 2], raw[:, 3])))
+                    rec = batch[-1]
+                    self.latest_sample = (
+                        rec['device_time_us'] / 1e6, [int(b) for b in rec['raw']],
+                        int(rec['battery']), int(rec['load_voltage']), int(rec['rpm']),
+                        int(rec['speed_mode']), int(rec['reverse']), int(rec['brake']),
+                        int(rec['regen']), POWER_STATES[rec['power_state'] & 3],
+                        int(rec['b2_direction']), float(rec['est_power']))
+                time.sleep(0.01)
+            except Exception as e:
+                print(f"Ring read error: {e}")
+                time.sleep(0.1)
+    
     def get_temp_color(self, temp_value, method='offset'):
         """Color code temperature values based on reasonableness"""
         if method == 'offset':
@@ -596,49 +742,39 @@ class SIFDashboard:
         for i, byte_val in enumerate(data['raw_bytes']):
             self.hex_labels[i].config(text=f"B{i}: {byte_val:02X}")
     
+    def refresh_labels(self):
+        # Coalesced to the display rate: however many samples arrived since the
+        # last tick, only the newest is shown.
+        if self.latest_sample is not None and self.samples.write_index != self.labels_index:
+            self.labels_index = self.samples.write_index
+            self.update_gui_values(self.build_data_point(*self.latest_sample))
+        if self.latency_us and self.latency_us is not self.latency_shown:
+            self.latency_shown = self.latency_us
+            self.update_latency_label()
+        self.root.after(DISPLAY_INTERVAL_MS, self.refresh_labels)
+    
     def update_plots(self, frame):
-        while not self.data_queue.empty():
-            try:
-                data = self.data_queue.get_nowait()
-                
-                self.timestamps.append(data['timestamp'])
-                self.battery_data.append(data['battery'])
-                self.rpm_data.append(data['rpm'])
-                self.load_voltage_data.append(data['load_voltage'])
-                self.b2_direction.append(data['b2_direction'])
-                self.est_power.append(data['est_power'])
-                
-                # NEW: Add temperature candidate data
-                self.byte0_data.append(data['byte0_raw'])
-                self.byte1_data.append(data['byte1_raw'])
-                self.byte2_data.append(data['byte2_raw'])
-                self.byte3_data.append(data['byte3_raw'])
-                
-                power_state_num = {'IDLE': 0, 'COAST': 1, 'LOAD': 2, 'REGEN': 3}.get(data['power_state'], 0)
-                self.power_state_data.append(power_state_num)
-                
-                self.root.after_idle(self.update_gui_values, data)
-                
-            except queue.Empty:
-                break
-        
-        if len(self.timestamps) > 0:
-            times = list(self.timestamps)
-            
-            self.lines['battery'].set_data(times, list(self.battery_data))
-            self.lines['rpm'].set_data(times, list(self.rpm_data))
-            self.lines['load_voltage'].set_data(times, list(self.load_voltage_data))
-            self.lines['power_state'].set_data(times, list(self.power_state_data))
-            self.lines['est_power'].set_data(times, list(self.est_power))
-            self.lines['direction'].set_data(times, list(self.b2_direction))
-            
-            for ax in self.axes.flat:
-                if len(times) > 1:
-                    ax.set_xlim(min(times), max(times))
-                ax.relim()
-                ax.autoscale_view(scalex=True, scaley=False)
-        
-        return list(self.lines.values())
+        # Blitting redraws only the returned artists, so they're returned even
+        # when nothing new arrived; returning none would blank the plots.
+        write_index = self.samples.write_index
+        if write_index == self.plotted_index:
+            return self.line_artists
+        self.plotted_index = write_index
+        
+        times = self.samples.view('timestamp', write_index)
+        # Only hand matplotlib the samples inside the visible window
+        first = np.searchsorted(times, times[-1] - PLOT_WINDOW_S)
+        x = times[first:] - times[-1]
+        def column(name):
+            return self.samples.view(name, write_index)[first:]
+        self.lines['battery'].set_data(x, column('battery'))
+        self.lines['rpm'].set_data(x, column('rpm'))
+        self.lines['load_voltage'].set_data(x, column('load_voltage'))
+        self.lines['power_state'].set_data(x, column('power_state'))
+        self.lines['est_power'].set_data(x, column('est_power'))
+        self.lines['direction'].set_data(x, column('b2_direction'))
+        
+        return self.line_artists
     
     def run(self):
         self.root.protocol("WM_DELETE_WINDOW", self.on_closing)
@@ -648,6 +784,57 @@ class SIFDashboard:
         self.disconnect_serial()
         plt.close('all')
         self.root.destroy()
+    
+    def bench(self, seconds):
+        """Headless throughput check: a producer thread feeds synthetic logger
+        rows through the normal parser as fast as it can while this thread
+        redraws the plots at the display rate, the way the GUI does."""
+        self.running = True
+        rows = [synthetic_row(i) for i in range(1000)]
+        
+        def produce():
+            i = 0
+            while self.running:
+                # Stamped at 50 Hz device time so the plot window holds a
+                # realistic number of points
+                self.parse_data_line(f"{i * 20000},{rows[i % len(rows)]}")
+                i += 1
+                if i % 64 == 0:
+                    time.sleep(0)  # A real port read releases the GIL while it waits
+        
+        canvas = self.fig.canvas
+        canvas.draw()
+        background = canvas.copy_from_bbox(self.fig.bbox)
+        producer = threading.Thread(target=produce, daemon=True)
+        
+        update_ms = []
+        start = time.perf_counter()
+        producer.start()
+        while time.perf_counter() - start < seconds:
+            t0 = time.perf_counter()
+            canvas.restore_region(background)
+            for line in self.update_plots(None):
+                line.axes.draw_artist(line)
+            canvas.blit(self.fig.bbox)
+            update_ms.append((time.perf_counter() - t0) * 1000)
+            time.sleep(max(0.0, DISPLAY_INTERVAL_MS / 1000 - (time.perf_counter() - t0)))
+        self.running = False
+        producer.join()
+        elapsed = time.perf_counter() - start
+        
+        update_ms.sort()
+        print(f"{self.samples.write_index} samples in {elapsed:.1f} s: "
+              f"{self.samples.write_index / elapsed:.0f} samples/s sustained")
+        print(f"{len(update_ms)} plot updates: p50 {update_ms[len(update_ms) // 2]:.2f} ms, "
+              f"max {update_ms[-1]:.2f} ms")
+
+def synthetic_row(i):
+    """A logger row without its timestamp column."""
+    rpm = int(3000 + 2500 * np.sin(i * 0.02))
+    raw = [60 + i % 20, 61, 62, 63, 0, 0, 0, 0, rpm >> 8 & 0xFF, rpm & 0xFF, 0, 0]
+    return ",".join(map(str, raw + [
+        80 - i % 50, 40 + i % 10, rpm, 1 + i % 3, 0, int(i % 7 == 0), int(i % 11 == 0),
+        POWER_STATES[i % 4], int(rpm > 500), f"{(i % 100) * 0.9:.1f}"]))
 
 if __name__ == "__main__":
     required_packages = ['serial', 'matplotlib', 'pandas', 'numpy']
@@ -667,5 +854,11 @@ if __name__ == "__main__":
         print("Install with: pip install", " ".join(missing_packages))
         sys.exit(1)
     
+    if "--bench" in sys.argv:
+        # python logger.py --bench [seconds]
+        args = sys.argv[sys.argv.index("--bench") + 1:]
+        SIFDashboard(headless=True).bench(float(args[0]) if args else 10.0)
+        sys.exit(0)
+    
     dashboard = SIFDashboard()
     dashboard.run()
\ No newline at end of file
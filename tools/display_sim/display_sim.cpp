@@ -0,0 +1,260 @@
+// display_sim: replays the dash's bar-gauge frames through DisplayTransport
+// on a simulated SPI bus and reports how much CPU time per frame the
+// asynchronous path hands back to loop(), compared with Adafruit_ST7789's
+// blocking writes (where the CPU waits out every byte).
+//
+//   display_sim                          default 40 MHz bus, 20 s of frames
+//   display_sim --spi-hz 26000000        slower bus
+//   display_sim --txn-ns 8000            costlier driver transactions
+//
+// CPU costs are model inputs, not measurements; calibrate them against
+// GAUGE_BENCH (time per update to queue and to glass) and DISPLAY_STATS on
+// the board. Both, like this tool, only count frames that drew something.
+//
+// Build (from the repo root): g++ -O2 -std=c++17 -Isrc -o display_sim tools/display_sim/display_sim.cpp src/display_transport.cpp
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "sim_transport.h"
+
+#define FRAME_INTERVAL_NS 50000000ull  // loop() redraws every 50 ms
+#define SIM_MAX_RPM 12000
+#define SIM_SEGMENTS 36
+#define COLOR_BACKGROUND 0x0000
+#define COLOR_TEXT_PRIMARY 0xFFFF
+#define COLOR_TEXT_SECONDARY 0x07FF
+
+struct CpuModel {
+  uint32_t gfxCallNs;  // Adafruit per-call overhead on top of the bytes (window setup, CS toggles)
+  uint32_t fillNs;     // Queueing one call into a DisplayBatch
+};
+
+// Classic 5x7 Adafruit_GFX glyphs, one byte per column, LSB at the top.
+struct Glyph {
+  char c;
+  uint8_t columns[5];
+};
+
+static const Glyph GLYPHS[] = {
+  {'0', {0x3E, 0x51, 0x49, 0x45, 0x3E}}, {'1', {0x00, 0x42, 0x7F, 0x40, 0x00}},
+  {'2', {0x42, 0x61, 0x51, 0x49, 0x46}}, {'3', {0x21, 0x41, 0x45, 0x4B, 0x31}},
+  {'4', {0x18, 0x14, 0x12, 0x7F, 0x10}}, {'5', {0x27, 0x45, 0x45, 0x45, 0x39}},
+  {'6', {0x3C, 0x4A, 0x49, 0x49, 0x30}}, {'7', {0x01, 0x71, 0x09, 0x05, 0x03}},
+  {'8', {0x36, 0x49, 0x49, 0x49, 0x36}}, {'9', {0x06, 0x49, 0x49, 0x29, 0x1E}},
+  {'M', {0x7F, 0x02, 0x1C, 0x02, 0x7F}}, {'P', {0x7F, 0x09, 0x09, 0x09, 0x06}},
+  {'H', {0x7F, 0x08, 0x08, 0x08, 0x7F}}, {'R', {0x7F, 0x09, 0x19, 0x29, 0x46}},
+};
+
+// Stands in for AsyncST7789: every call goes to the transport, and is also
+// charged to the blocking model the way Adafruit_ST7789 would run it.
+class SimDisplay {
+private:
+  SimulatedTransport& transport;
+  SimBusModel bus;
+  CpuModel cpu;
+
+public:
+  uint64_t blockingNs;
+  uint32_t calls;
+
+  SimDisplay(SimulatedTransport& simTransport, const SimBusModel& busModel, const CpuModel& cpuModel)
+      : transport(simTransport) {
+    bus = busModel;
+    cpu = cpuModel;
+    blockingNs = 0;
+    calls = 0;
+  }
+
+  void fillRect(int x, int y, int w, int h, uint16_t color) {
+    uint64_t bytes = DISPLAY_WINDOW_BYTES + 2ull * w * h;
+    blockingNs += cpu.gfxCallNs + bytes * 8 * 1000000000ull / bus.spiHz;
+    calls++;
+    transport.fill(x, y, w, h, color);
+    transport.advance(cpu.fillNs);
+  }
+
+  // Adafruit_GFX::drawChar for the built-in font: a pixel (or size x size
+  // block) per lit dot, column by column.
+  int drawText(int x, int y, const char* text, int size, uint16_t color) {
+    for (const char* p = text; *p; p++, x += 6 * size) {
+      const Glyph* glyph = nullptr;
+      for (const Glyph& g : GLYPHS) {
+        if (g.c == *p) glyph = &g;
+      }
+      if (!glyph) continue;
+      for (int i = 0; i < 5; i++) {
+        uint8_t line = glyph->columns[i];
+        for (int j = 0; j < 8; j++, line >>= 1) {
+          if (line & 1) fillRect(x + i * size, y + j * size, size, size, color);
+        }
+      }
+    }
+    return x;
+  }
+};
+
+// Same draw calls as VehicleUI::drawBarGauge.
+static void drawBarGauge(SimDisplay& display, int activeSegments) {
+  display.fillRect(0, 10, 30, 191, COLOR_BACKGROUND);
+  display.fillRect(290, 10, 30, 191, COLOR_BACKGROUND);
+  uint16_t color = activeSegments > 30 ? 0xF800 : (activeSegments > 20 ? 0xFFE0 : 0x07E0);
+  for (int i = 0; i < activeSegments; i++) {
+    int yPos = 190 - i * 5;
+    display.fillRect(2, yPos - 4, 26, 4, color);
+    display.fillRect(292, yPos - 4, 26, 4, color);
+  }
+}
+
+// Same draw calls as the bar-style branch of VehicleUI::drawMphReadout.
+static void drawMphReadout(SimDisplay& display, int mph, int rpm) {
+  char text[16];
+  display.fillRect(50, 45, 220, 100, COLOR_BACKGROUND);
+  snprintf(text, sizeof(text), "%d", mph);
+  display.drawText(80, 45, text, 8, COLOR_TEXT_PRIMARY);
+  display.drawText(200, 85, "MPH", 3, COLOR_TEXT_PRIMARY);
+  snprintf(text, sizeof(text), "%d", rpm);
+  int x = display.drawText(120, 130, text, 2, COLOR_TEXT_SECONDARY);
+  display.drawText(x + 12, 130, "RPM", 2, COLOR_TEXT_SECONDARY);
+}
+
+static double percentile(std::vector<double> values, int pct) {
+  if (values.empty()) return 0;
+  size_t rank = std::min(values.size() - 1, (values.size() * pct + 99) / 100 - 1);
+  std::nth_element(values.begin(), values.begin() + rank, values.end());
+  return values[rank];
+}
+
+// A frame bigger than one batch leaves its first buffer on the bus at
+// endFrame(); if that buffer finishes before the next frame draws, it must
+// still come back empty rather than re-ship the old commands.
+static bool checkBatchReuse(const SimBusModel& bus) {
+  SimulatedTransport transport(bus);
+  for (int i = 0; i < DISPLAY_BATCH_COMMANDS; i++) {
+    transport.fill(i % 20 * 16, i / 20 * 16, 16, 16, i % 2 ? 0xFFFF : 0x0000);
+  }
+  for (int i = 0; i < 44; i++) {
+    transport.fill(i * 2, 0, 1, 1, 0xFFFF);
+  }
+  transport.endFrame();
+  transport.advance(FRAME_INTERVAL_NS);
+  transport.fill(0, 0, 10, 10, 0xF800);
+  uint32_t fence = transport.endFrame();
+  transport.waitFor(fence);
+
+  uint64_t expected = DISPLAY_BATCH_COMMANDS + 45;
+  if (transport.shipped() != expected || transport.getStats().commands != expected) {
+    fprintf(stderr, "batch reuse check: shipped %llu commands, expected %llu\n",
+            (unsigned long long)transport.shipped(), (unsigned long long)expected);
+    return false;
+  }
+  return true;
+}
+
+static void usage(const char* argv0) {
+  fprintf(stderr,
+          "usage: %s [--frames N] [--spi-hz HZ] [--gap-ns NS] [--txn-ns NS]\n"
+          "          [--gfx-ns NS] [--fill-ns NS]\n",
+          argv0);
+}
+
+int main(int argc, char** argv) {
+  SimBusModel bus = {40000000, 1000, 4000};
+  CpuModel cpu = {1000, 300};
+  int frames = 400;
+
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--frames") == 0 && hasValue) frames = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--spi-hz") == 0 && hasValue) bus.spiHz = strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--gap-ns") == 0 && hasValue) bus.transactionGapNs = strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--txn-ns") == 0 && hasValue) bus.transactionCpuNs = strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--gfx-ns") == 0 && hasValue) cpu.gfxCallNs = strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--fill-ns") == 0 && hasValue) cpu.fillNs = strtoul(argv[++i], nullptr, 10);
+    else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (frames <= 0 || bus.spiHz == 0) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  if (!checkBatchReuse(bus)) return 1;
+
+  SimulatedTransport transport(bus);
+  SimDisplay display(transport, bus, cpu);
+  std::vector<double> glassMs;
+  uint64_t asyncNs = 0;
+  uint64_t blockingNs = 0;
+  uint32_t drawn = 0;
+  int lastSegments = -1;
+  int lastMph = -999;
+
+  for (int frame = 0; frame < frames; frame++) {
+    uint64_t frameStart = frame * FRAME_INTERVAL_NS;
+    transport.advanceTo(frameStart);
+
+    // Sweep up and back down over 4 s, like GAUGE_BENCH
+    int phase = frame % 80;
+    int rpm = (phase < 40 ? phase : 80 - phase) * SIM_MAX_RPM / 40;
+    int mph = rpm / 200;
+    int segments = rpm * SIM_SEGMENTS / SIM_MAX_RPM;
+
+    uint64_t blockingBefore = display.blockingNs;
+    uint64_t cpuStart = transport.clock();
+    bool changed = false;
+    if (segments != lastSegments) {
+      drawBarGauge(display, segments);
+      lastSegments = segments;
+      changed = true;
+    }
+    if (abs(mph - lastMph) > 1) {
+      drawMphReadout(display, mph, rpm);
+      lastMph = mph;
+      changed = true;
+    }
+    uint32_t fence = transport.endFrame();
+    if (!changed) continue;
+
+    drawn++;
+    asyncNs += transport.clock() - cpuStart;
+    blockingNs += display.blockingNs - blockingBefore;
+    glassMs.push_back((transport.busFree() - frameStart) / 1e6);
+    if (transport.isComplete(fence) && transport.busFree() > transport.clock()) {
+      fprintf(stderr, "fence %u completed before its last byte\n", fence);
+      return 1;
+    }
+  }
+
+  const DisplayTransportStats& stats = transport.getStats();
+  transport.waitFor(transport.endFrame());
+  if (transport.shipped() != stats.commands) {
+    fprintf(stderr, "transport shipped %llu commands, %u were queued\n",
+            (unsigned long long)transport.shipped(), stats.commands);
+    return 1;
+  }
+  if (stats.frames != drawn) {
+    fprintf(stderr, "transport counted %u frames, %u drew something\n", stats.frames, drawn);
+    return 1;
+  }
+  double perFrame = drawn ? 1.0 / drawn : 0;
+  printf("model: %.1f MHz SPI, %u ns gap + %u ns driver CPU per transaction, %u ns per blocking call,"
+         " %u ns per queued call\n",
+         bus.spiHz / 1e6, bus.transactionGapNs, bus.transactionCpuNs, cpu.gfxCallNs, cpu.fillNs);
+  printf("%u frames with changes (of %d): %.0f calls -> %.0f windows (%.0f coalesced), %.0f px per frame\n",
+         drawn, frames, display.calls * perFrame, stats.commands * perFrame, stats.coalesced * perFrame,
+         stats.pixels * perFrame);
+  printf("bus busy:      %.3f ms/frame\n", transport.busBusy() / 1e6 * perFrame);
+  printf("blocking CPU:  %.3f ms/frame\n", blockingNs / 1e6 * perFrame);
+  printf("async CPU:     %.3f ms/frame (driver %.3f, stalls %.3f)\n", asyncNs / 1e6 * perFrame,
+         transport.driverCpu() / 1e6 * perFrame, stats.stallUs / 1e3 * perFrame);
+  printf("recovered:     %.3f ms/frame (%.0f%%)\n", ((double)blockingNs - asyncNs) / 1e6 * perFrame,
+         blockingNs ? 100.0 * ((double)blockingNs - asyncNs) / blockingNs : 0);
+  printf("draw-to-glass: p50 %.3f ms, p99 %.3f ms\n", percentile(glassMs, 50), percentile(glassMs, 99));
+  return 0;
+}
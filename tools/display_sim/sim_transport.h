@@ -0,0 +1,104 @@
+#ifndef SIM_TRANSPORT_H
+#define SIM_TRANSPORT_H
+
+#include <cstdint>
+
+#include "display_transport.h"
+
+// Host backend for DisplayTransport. Nothing is sent anywhere: each batch
+// occupies a simulated SPI bus for as long as SpiDmaTransport would keep the
+// real one busy, measured on a virtual clock that the caller advances as it
+// spends CPU time.
+
+struct SimBusModel {
+  uint32_t spiHz;
+  uint32_t transactionGapNs;  // Bus idle per SPI transaction (CS, D/C, driver ISR)
+  uint32_t transactionCpuNs;  // CPU the driver task takes per transaction
+};
+
+class SimulatedTransport : public DisplayTransport {
+private:
+  SimBusModel model;
+  uint64_t clockNs;
+  uint64_t busFreeNs;
+  uint64_t busBusyNs;
+  uint64_t driverCpuNs;
+  uint64_t commandsShipped;
+  int pendingIndex[2];     // In-flight batches, oldest first
+  uint64_t pendingDoneNs[2];
+  int pendingCount;
+
+  void poll() {
+    while (pendingCount > 0 && pendingDoneNs[0] <= clockNs) {
+      batchComplete(pendingIndex[0], pendingDoneNs[0] / 1000);
+      pendingIndex[0] = pendingIndex[1];
+      pendingDoneNs[0] = pendingDoneNs[1];
+      pendingCount--;
+    }
+  }
+
+protected:
+  // Same transaction split as SpiDmaTransport::shipCommand: five for the
+  // address window, then one per DISPLAY_DMA_CHUNK_PIXELS of the run.
+  void startBatch(const DisplayBatch& batch, int index) override {
+    uint64_t bytes = 0;
+    uint64_t transactions = 0;
+    for (int i = 0; i < batch.count; i++) {
+      uint32_t pixels = (uint32_t)batch.commands[i].w * batch.commands[i].h;
+      bytes += DISPLAY_WINDOW_BYTES + 2ull * pixels;
+      transactions += 5 + (pixels + DISPLAY_DMA_CHUNK_PIXELS - 1) / DISPLAY_DMA_CHUNK_PIXELS;
+    }
+    uint64_t busNs = bytes * 8 * 1000000000ull / model.spiHz + transactions * model.transactionGapNs;
+    uint64_t start = busFreeNs > clockNs ? busFreeNs : clockNs;
+    busFreeNs = start + busNs;
+    busBusyNs += busNs;
+    commandsShipped += batch.count;
+
+    pendingIndex[pendingCount] = index;
+    pendingDoneNs[pendingCount] = busFreeNs;
+    pendingCount++;
+
+    // The driver task preempts loop() for its share of the work
+    driverCpuNs += transactions * model.transactionCpuNs;
+    advance(transactions * model.transactionCpuNs);
+  }
+
+  void waitForBatch() override {
+    if (pendingCount == 0) return;
+    if (clockNs < pendingDoneNs[0]) clockNs = pendingDoneNs[0];
+    poll();
+  }
+
+  uint64_t nowUs() override {
+    return clockNs / 1000;
+  }
+
+public:
+  explicit SimulatedTransport(const SimBusModel& busModel) {
+    model = busModel;
+    clockNs = 0;
+    busFreeNs = 0;
+    busBusyNs = 0;
+    driverCpuNs = 0;
+    commandsShipped = 0;
+    pendingCount = 0;
+  }
+
+  // Spends `ns` of CPU time; batches whose last byte went out meanwhile complete.
+  void advance(uint64_t ns) {
+    clockNs += ns;
+    poll();
+  }
+
+  void advanceTo(uint64_t ns) {
+    if (ns > clockNs) advance(ns - clockNs);
+  }
+
+  uint64_t clock() const { return clockNs; }
+  uint64_t busFree() const { return busFreeNs; }
+  uint64_t busBusy() const { return busBusyNs; }
+  uint64_t driverCpu() const { return driverCpuNs; }
+  uint64_t shipped() const { return commandsShipped; }
+};
+
+#endif
@@ -0,0 +1,440 @@
+// sif_ingest: owns the dash's serial port and republishes every logger row as
+// a fixed-layout record in a shared-memory ring (see sif_ring.h).
+//
+//   sif_ingest --device /dev/ttyACM0        read the dash
+//   sif_ingest --pty                        create a pty and print its path
+//   sif_ingest --bench 1000000              parse synthetic rows and exit
+//
+// Build: g++ -O2 -std=c++17 -o sif_ingest sif_ingest.cpp -lrt
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sif_ring.h"
+
+#define READ_BUFFER_SIZE 65536
+#define DEFAULT_STATS_MS 1000
+
+static volatile sig_atomic_t running = 1;
+
+static void onSignal(int) {
+  running = 0;
+}
+
+static uint64_t nowNs(clockid_t clock) {
+  timespec ts;
+  clock_gettime(clock, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// Field parsers work on [p, end) and advance p past the trailing comma.
+static bool parseInt(const char*& p, const char* end, long& out) {
+  bool negative = false;
+  if (p < end && *p == '-') {
+    negative = true;
+    p++;
+  }
+  const char* start = p;
+  long value = 0;
+  while (p < end && *p >= '0' && *p <= '9') {
+    value = value * 10 + (*p - '0');
+    p++;
+  }
+  if (p == start) return false;
+  out = negative ? -value : value;
+  return true;
+}
+
+// Accepts "12.345" (seconds) or "12345000" (microseconds) so rows from
+// either logger timestamp format land in the same unit.
+static bool parseTimestampUs(const char*& p, const char* end, uint64_t& out) {
+  long whole;
+  if (!parseInt(p, end, whole) || whole < 0) return false;
+  if (p < end && *p == '.') {
+    p++;
+    uint64_t frac = 0;
+    int digits = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+      if (digits < 6) {
+        frac = frac * 10 + (*p - '0');
+        digits++;
+      }
+      p++;
+    }
+    while (digits < 6) {
+      frac *= 10;
+      digits++;
+    }
+    out = (uint64_t)whole * 1000000ull + frac;
+  } else {
+    out = (uint64_t)whole;
+  }
+  return true;
+}
+
+static bool parseFloat(const char*& p, const char* end, float& out) {
+  long whole;
+  bool negative = (p < end && *p == '-');
+  if (!parseInt(p, end, whole)) return false;
+  float value = (float)(negative ? -whole : whole);
+  if (p < end && *p == '.') {
+    p++;
+    float scale = 0.1f;
+    while (p < end && *p >= '0' && *p <= '9') {
+      value += (*p - '0') * scale;
+      scale *= 0.1f;
+      p++;
+    }
+  }
+  out = negative ? -value : value;
+  return true;
+}
+
+static bool expectComma(const char*& p, const char* end) {
+  if (p < end && *p == ',') {
+    p++;
+    return true;
+  }
+  return false;
+}
+
+static uint8_t parsePowerState(const char*& p, const char* end) {
+  const char* start = p;
+  while (p < end && *p != ',') p++;
+  size_t len = p - start;
+  if (len == 5 && memcmp(start, "COAST", 5) == 0) return SIF_POWER_COAST;
+  if (len == 4 && memcmp(start, "LOAD", 4) == 0) return SIF_POWER_LOAD;
+  if (len == 5 && memcmp(start, "REGEN", 5) == 0) return SIF_POWER_REGEN;
+  return SIF_POWER_IDLE;
+}
+
+// Parses one row of sendDataToLogger() output into `rec` (everything except
+// seq/hostTimeNs). Returns false for headers, comments, LAT rows and
+// malformed rows.
+static bool parseSifLine(const char* p, const char* end, SifRecord& rec) {
+  if (p == end || *p < '0' || *p > '9') return false;
+
+  long v;
+  if (!parseTimestampUs(p, end, rec.deviceTimeUs) || !expectComma(p, end)) return false;
+  for (int i = 0; i < 12; i++) {
+    if (!parseInt(p, end, v) || !expectComma(p, end)) return false;
+    rec.raw[i] = (uint8_t)v;
+  }
+  if (!parseInt(p, end, v) || !expectComma(p, end)) return false;
+  rec.battery = (int16_t)v;
+  if (!parseInt(p, end, v) || !expectComma(p, end)) return false;
+  rec.loadVoltage = (int16_t)v;
+  if (!parseInt(p, end, v) || !expectComma(p, end)) return false;
+  rec.rpm = (int32_t)v;
+  if (!parseInt(p, end, v) || !expectComma(p, end)) return false;
+  rec.speedMode = (uint8_t)v;
+  if (!parseInt(p, end, v) || !expectComma(p, end)) return false;
+  rec.reverse = v != 0;
+  if (!parseInt(p, end, v) || !expectComma(p, end)) return false;
+  rec.brake = v != 0;
+  if (!parseInt(p, end, v) || !expectComma(p, end)) return false;
+  rec.regen = v != 0;
+  rec.powerState = parsePowerState(p, end);
+  if (!expectComma(p, end)) return false;
+  if (!parseInt(p, end, v) || !expectComma(p, end)) return false;
+  rec.b2Direction = (uint8_t)v;
+  if (!parseFloat(p, end, rec.estPower)) return false;
+  return true;
+}
+
+class SifRingWriter {
+private:
+  SifRingHeader* header;
+  SifRecord* records;
+  size_t mappedBytes;
+  char name[64];
+
+public:
+  SifRingWriter() : header(nullptr), records(nullptr), mappedBytes(0) {
+    name[0] = 0;
+  }
+
+  ~SifRingWriter() {
+    if (header) {
+      header->writerPid.store(0, std::memory_order_release);
+      munmap(header, mappedBytes);
+      shm_unlink(name);
+    }
+  }
+
+  // Pid of a live writer already publishing into the named ring, else 0.
+  static pid_t liveWriter(const char* ringName) {
+    int fd = shm_open(ringName, O_RDONLY, 0);
+    if (fd < 0) return 0;
+    pid_t pid = 0;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(SifRingHeader)) {
+      void* base = mmap(nullptr, sizeof(SifRingHeader), PROT_READ, MAP_SHARED, fd, 0);
+      if (base != MAP_FAILED) {
+        const SifRingHeader* existing = static_cast<const SifRingHeader*>(base);
+        if (existing->magic == SIF_RING_MAGIC) {
+          pid = (pid_t)existing->writerPid.load(std::memory_order_acquire);
+        }
+        munmap(base, sizeof(SifRingHeader));
+      }
+    }
+    close(fd);
+    if (pid == 0 || (kill(pid, 0) != 0 && errno == ESRCH)) return 0;
+    return pid;
+  }
+
+  // Replaces a stale ring left by a writer that died, but never one that is
+  // still live: its readers would stay on the unlinked segment.
+  bool open(const char* ringName, uint32_t capacity) {
+    pid_t owner = liveWriter(ringName);
+    if (owner != 0) {
+      fprintf(stderr, "ring %s is owned by running writer pid %d\n", ringName, (int)owner);
+      return false;
+    }
+    snprintf(name, sizeof(name), "%s", ringName);
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+      perror("shm_open");
+      return false;
+    }
+    mappedBytes = sifRingBytes(capacity);
+    if (ftruncate(fd, mappedBytes) != 0) {
+      perror("ftruncate");
+      close(fd);
+      return false;
+    }
+    void* base = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+      perror("mmap");
+      return false;
+    }
+    header = static_cast<SifRingHeader*>(base);
+    records = sifRingRecords(header);
+    header->recordSize = sizeof(SifRecord);
+    header->capacity = capacity;
+    header->version = SIF_RING_VERSION;
+    header->writerPid.store(getpid(), std::memory_order_relaxed);
+    header->magic = SIF_RING_MAGIC;
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+  }
+
+  // Readers only ever see a slot whose seq matches the sequence they expect,
+  // so the payload is written between invalidating and re-stamping seq.
+  void publish(const SifRecord& rec) {
+    uint64_t seq = header->writeSeq.load(std::memory_order_relaxed);
+    SifRecord& slot = records[seq % header->capacity];
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(reinterpret_cast<uint8_t*>(&slot) + sizeof(slot.seq),
+           reinterpret_cast<const uint8_t*>(&rec) + sizeof(rec.seq),
+           sizeof(SifRecord) - sizeof(rec.seq));
+    slot.seq.store(seq + 1, std::memory_order_release);
+    header->writeSeq.store(seq + 1, std::memory_order_release);
+  }
+
+  SifRingHeader* getHeader() {
+    return header;
+  }
+};
+
+static bool configureSerial(int fd, int baud) {
+  termios tio;
+  if (tcgetattr(fd, &tio) != 0) return false;
+  cfmakeraw(&tio);
+  speed_t speed = B115200;
+  if (baud == 230400) speed = B230400;
+  else if (baud == 460800) speed = B460800;
+  else if (baud == 921600) speed = B921600;
+  cfsetispeed(&tio, speed);
+  cfsetospeed(&tio, speed);
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+  return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+static int openPty() {
+  int fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+    perror("posix_openpt");
+    return -1;
+  }
+  // Hold the slave side open (raw, like the real port) so the master doesn't
+  // report hangup between feeders.
+  int slave = open(ptsname(fd), O_RDWR | O_NOCTTY);
+  if (slave < 0 || !configureSerial(slave, 115200)) {
+    perror(ptsname(fd));
+    return -1;
+  }
+  printf("pty: %s\n", ptsname(fd));
+  fflush(stdout);
+  return fd;
+}
+
+struct IngestStats {
+  uint64_t lines;
+  uint64_t rejected;
+  uint64_t bytes;
+  uint64_t parseNs;
+};
+
+static void reportStats(SifRingHeader* header, IngestStats& stats, uint64_t elapsedNs) {
+  double seconds = elapsedNs / 1e9;
+  uint64_t writeSeq = header->writeSeq.load(std::memory_order_acquire);
+  fprintf(stderr, "# ingest: %.0f rows/s, %.1f KB/s, %.0f ns/row parse, %llu rejected, seq %llu\n",
+          stats.lines / seconds, stats.bytes / seconds / 1024.0,
+          stats.lines ? (double)stats.parseNs / stats.lines : 0.0,
+          (unsigned long long)stats.rejected, (unsigned long long)writeSeq);
+
+  for (int i = 0; i < SIF_RING_MAX_READERS; i++) {
+    SifReaderSlot& slot = header->readers[i];
+    uint32_t pid = slot.pid.load(std::memory_order_acquire);
+    if (pid == 0) continue;
+    if (kill(pid, 0) != 0 && errno == ESRCH) {
+      // Reader died without detaching; free its slot.
+      slot.pid.compare_exchange_strong(pid, 0);
+      continue;
+    }
+    uint64_t cursor = slot.cursor.load(std::memory_order_acquire);
+    uint64_t lag = writeSeq > cursor ? writeSeq - cursor : 0;
+    fprintf(stderr, "#   reader %u: lag %llu records%s\n", pid, (unsigned long long)lag,
+            lag > header->capacity ? " (overrun)" : "");
+  }
+  stats = IngestStats();
+}
+
+static int runBench(long rows) {
+  const char* sample = "1234.567,10,64,0,0,163,0,12,5,220,78,0,52,78,63,1600,3,0,0,0,LOAD,1,3.25";
+  const char* end = sample + strlen(sample);
+  SifRecord rec;
+  uint64_t checksum = 0;
+  uint64_t start = nowNs(CLOCK_MONOTONIC);
+  for (long i = 0; i < rows; i++) {
+    if (parseSifLine(sample, end, rec)) checksum += rec.rpm;
+  }
+  uint64_t elapsed = nowNs(CLOCK_MONOTONIC) - start;
+  printf("parsed %ld rows in %.3f ms: %.1f ns/row, %.2f M rows/s (checksum %llu)\n", rows,
+         elapsed / 1e6, (double)elapsed / rows, rows * 1e3 / elapsed, (unsigned long long)checksum);
+  return 0;
+}
+
+static void usage(const char* argv0) {
+  fprintf(stderr,
+          "usage: %s (--device PATH | --pty | --bench ROWS) [--baud N] [--ring NAME]\n"
+          "          [--capacity RECORDS] [--stats MS]\n",
+          argv0);
+}
+
+int main(int argc, char** argv) {
+  const char* device = nullptr;
+  const char* ringName = SIF_RING_DEFAULT_NAME;
+  bool usePty = false;
+  int baud = 115200;
+  uint32_t capacity = SIF_RING_DEFAULT_CAPACITY;
+  int statsMs = DEFAULT_STATS_MS;
+
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--device") == 0 && hasValue) device = argv[++i];
+    else if (strcmp(argv[i], "--pty") == 0) usePty = true;
+    else if (strcmp(argv[i], "--baud") == 0 && hasValue) baud = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--ring") == 0 && hasValue) ringName = argv[++i];
+    else if (strcmp(argv[i], "--capacity") == 0 && hasValue) capacity = strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--stats") == 0 && hasValue) statsMs = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--bench") == 0 && hasValue) return runBench(atol(argv[++i]));
+    else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if ((device == nullptr) == !usePty || capacity == 0) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  int fd;
+  if (usePty) {
+    fd = openPty();
+  } else {
+    fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd >= 0 && !configureSerial(fd, baud)) {
+      perror("tcsetattr");
+      return 1;
+    }
+  }
+  if (fd < 0) {
+    perror(device ? device : "pty");
+    return 1;
+  }
+
+  SifRingWriter ring;
+  if (!ring.open(ringName, capacity)) return 1;
+  SifRingHeader* header = ring.getHeader();
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  static char buffer[READ_BUFFER_SIZE];
+  size_t used = 0;
+  IngestStats stats = IngestStats();
+  uint64_t lastReport = nowNs(CLOCK_MONOTONIC);
+  SifRecord rec{};
+
+  while (running) {
+    pollfd pfd = {fd, POLLIN, 0};
+    int ready = poll(&pfd, 1, 100);
+    if (ready > 0) {
+      ssize_t n = read(fd, buffer + used, sizeof(buffer) - used);
+      if (n > 0) {
+        stats.bytes += n;
+        used += n;
+        uint64_t parseStart = nowNs(CLOCK_MONOTONIC);
+        uint64_t wallNs = nowNs(CLOCK_REALTIME);
+        char* lineStart = buffer;
+        char* end = buffer + used;
+        char* newline;
+        while ((newline = static_cast<char*>(memchr(lineStart, '\n', end - lineStart)))) {
+          char* lineEnd = newline;
+          if (lineEnd > lineStart && lineEnd[-1] == '\r') lineEnd--;
+          if (parseSifLine(lineStart, lineEnd, rec)) {
+            rec.hostTimeNs = wallNs;
+            ring.publish(rec);
+            stats.lines++;
+          } else if (lineEnd > lineStart && *lineStart >= '0' && *lineStart <= '9') {
+            stats.rejected++;
+          }
+          lineStart = newline + 1;
+        }
+        stats.parseNs += nowNs(CLOCK_MONOTONIC) - parseStart;
+        used = end - lineStart;
+        if (used == sizeof(buffer)) used = 0;  // no newline in a full buffer: drop it
+        memmove(buffer, lineStart, used);
+      } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+        break;
+      }
+    }
+
+    uint64_t now = nowNs(CLOCK_MONOTONIC);
+    if (now - lastReport >= (uint64_t)statsMs * 1000000ull) {
+      header->linesParsed.fetch_add(stats.lines, std::memory_order_relaxed);
+      header->linesRejected.fetch_add(stats.rejected, std::memory_order_relaxed);
+      reportStats(header, stats, now - lastReport);
+      lastReport = now;
+    }
+  }
+
+  close(fd);
+  return 0;
+}
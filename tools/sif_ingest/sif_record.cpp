@@ -0,0 +1,94 @@
+// sif_record: attaches to the sif_ingest ring as a reader and writes every
+// record as a CSV row, to a file or stdout.
+//
+//   sif_record [--ring NAME] [--from-oldest] [OUTPUT.csv]
+//
+// Build: g++ -O2 -std=c++17 -o sif_record sif_record.cpp -lrt
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "sif_ring.h"
+
+#define IDLE_SLEEP_US 1000
+
+static volatile sig_atomic_t running = 1;
+
+static void onSignal(int) {
+  running = 0;
+}
+
+static const char* powerStateName(uint8_t state) {
+  switch (state) {
+    case SIF_POWER_COAST: return "COAST";
+    case SIF_POWER_LOAD: return "LOAD";
+    case SIF_POWER_REGEN: return "REGEN";
+    default: return "IDLE";
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* ringName = SIF_RING_DEFAULT_NAME;
+  const char* outputPath = nullptr;
+  bool fromOldest = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--ring") == 0 && i + 1 < argc) ringName = argv[++i];
+    else if (strcmp(argv[i], "--from-oldest") == 0) fromOldest = true;
+    else if (argv[i][0] != '-' && !outputPath) outputPath = argv[i];
+    else {
+      fprintf(stderr, "usage: %s [--ring NAME] [--from-oldest] [OUTPUT.csv]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  SifRingReader reader;
+  if (!reader.open(ringName, fromOldest)) {
+    fprintf(stderr, "cannot attach to ring %s (is sif_ingest running?)\n", ringName);
+    return 1;
+  }
+
+  FILE* out = outputPath ? fopen(outputPath, "w") : stdout;
+  if (!out) {
+    perror(outputPath);
+    return 1;
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  fprintf(out, "Seq,HostTimeNs,DeviceTimeUs,Byte0,Byte1,Byte2,Byte3,Byte4,Byte5,Byte6,Byte7,Byte8,"
+               "Byte9,Byte10,Byte11,Battery,LoadVoltage,RPM,SpeedMode,Reverse,Brake,Regen,"
+               "PowerState,B2Direction,EstPower\n");
+
+  uint64_t written = 0;
+  while (running) {
+    const SifRecord* shared = reader.next();
+    if (!shared) {
+      if (!reader.writerAlive()) break;
+      fflush(out);
+      usleep(IDLE_SLEEP_US);
+      continue;
+    }
+
+    SifRecord rec;
+    memcpy(static_cast<void*>(&rec), shared, sizeof(rec));
+    if (!reader.stillValid(shared)) continue;
+
+    fprintf(out, "%llu,%llu,%llu,", (unsigned long long)(reader.position() - 1),
+            (unsigned long long)rec.hostTimeNs, (unsigned long long)rec.deviceTimeUs);
+    for (int i = 0; i < 12; i++) fprintf(out, "%u,", rec.raw[i]);
+    fprintf(out, "%d,%d,%d,%u,%u,%u,%u,%s,%u,%.2f\n", rec.battery, rec.loadVoltage, rec.rpm,
+            rec.speedMode, rec.reverse, rec.brake, rec.regen, powerStateName(rec.powerState),
+            rec.b2Direction, rec.estPower);
+    written++;
+  }
+
+  fflush(out);
+  fprintf(stderr, "# recorded %llu records, %llu dropped\n", (unsigned long long)written,
+          (unsigned long long)reader.droppedCount());
+  if (out != stdout) fclose(out);
+  return 0;
+}
@@ -0,0 +1,199 @@
+#ifndef SIF_RING_H
+#define SIF_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Shared-memory layout published by sif_ingest. One writer, up to
+// SIF_RING_MAX_READERS readers. The segment is a page-sized header followed
+// by `capacity` fixed-size records. Keep in sync with sif_ring.py.
+
+#define SIF_RING_MAGIC 0x53494652u  // "SIFR"
+#define SIF_RING_VERSION 1
+#define SIF_RING_DEFAULT_NAME "/sif_ring"
+#define SIF_RING_DEFAULT_CAPACITY 65536
+#define SIF_RING_MAX_READERS 16
+#define SIF_RING_HEADER_SIZE 4096
+
+enum SifPowerState : uint8_t {
+  SIF_POWER_IDLE = 0,
+  SIF_POWER_COAST = 1,
+  SIF_POWER_LOAD = 2,
+  SIF_POWER_REGEN = 3
+};
+
+// One logger row from the dash. `seq` is written last with release order and
+// holds (record sequence + 1), so a reader can detect a slot that has been
+// overwritten while it was copying it.
+struct SifRecord {
+  std::atomic<uint64_t> seq;
+  uint64_t hostTimeNs;     // CLOCK_REALTIME at parse
+  uint64_t deviceTimeUs;   // device timestamp column, in microseconds
+  uint8_t raw[12];
+  int16_t battery;
+  int16_t loadVoltage;
+  int32_t rpm;
+  float estPower;
+  uint8_t speedMode;
+  uint8_t reverse;
+  uint8_t brake;
+  uint8_t regen;
+  uint8_t powerState;
+  uint8_t b2Direction;
+  uint8_t reserved[10];
+};
+
+struct SifReaderSlot {
+  std::atomic<uint32_t> pid;       // 0 when free
+  uint32_t reserved;
+  std::atomic<uint64_t> cursor;    // next sequence the reader will consume
+};
+
+struct SifRingHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t recordSize;
+  uint32_t capacity;
+  std::atomic<uint64_t> writeSeq;        // sequence of the next record to publish
+  std::atomic<uint64_t> linesParsed;
+  std::atomic<uint64_t> linesRejected;
+  std::atomic<uint32_t> writerPid;
+  uint32_t reserved;
+  SifReaderSlot readers[SIF_RING_MAX_READERS];
+};
+
+static_assert(sizeof(SifRecord) == 64, "SifRecord layout is shared with readers");
+static_assert(offsetof(SifRecord, raw) == 24, "SifRecord layout is shared with readers");
+static_assert(offsetof(SifRecord, estPower) == 44, "SifRecord layout is shared with readers");
+static_assert(sizeof(SifRingHeader) <= SIF_RING_HEADER_SIZE, "header must fit its page");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring needs lock-free 64-bit atomics");
+
+inline size_t sifRingBytes(uint32_t capacity) {
+  return SIF_RING_HEADER_SIZE + (size_t)capacity * sizeof(SifRecord);
+}
+
+inline SifRecord* sifRingRecords(SifRingHeader* header) {
+  return reinterpret_cast<SifRecord*>(reinterpret_cast<uint8_t*>(header) + SIF_RING_HEADER_SIZE);
+}
+
+// Attaches to a published ring as one of its readers. Records are read in
+// place; `next()` returns a pointer into the shared segment that stays valid
+// until the writer wraps around to it, so callers that keep a record past
+// the next call must copy it and then check `stillValid()`.
+class SifRingReader {
+private:
+  SifRingHeader* header;
+  SifRecord* records;
+  size_t mappedBytes;
+  int slotIndex;
+  uint64_t cursor;
+  uint64_t dropped;
+
+public:
+  SifRingReader()
+    : header(nullptr), records(nullptr), mappedBytes(0), slotIndex(-1), cursor(0), dropped(0) {}
+
+  ~SifRingReader() {
+    close();
+  }
+
+  bool open(const char* name, bool fromOldest) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < SIF_RING_HEADER_SIZE) {
+      ::close(fd);
+      return false;
+    }
+    void* base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+      ::close(fd);
+      return false;
+    }
+    header = static_cast<SifRingHeader*>(base);
+    mappedBytes = st.st_size;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->magic != SIF_RING_MAGIC || header->version != SIF_RING_VERSION ||
+        header->recordSize != sizeof(SifRecord) || sifRingBytes(header->capacity) > mappedBytes) {
+      ::close(fd);
+      close();
+      return false;
+    }
+    records = sifRingRecords(header);
+
+    // Claims are serialized with flock on the segment so Python readers,
+    // which can't CAS, never take the same slot as us (see sif_ring.py).
+    flock(fd, LOCK_EX);
+    for (int i = 0; i < SIF_RING_MAX_READERS && slotIndex < 0; i++) {
+      uint32_t expected = 0;
+      if (header->readers[i].pid.compare_exchange_strong(expected, (uint32_t)getpid())) {
+        slotIndex = i;
+      }
+    }
+    flock(fd, LOCK_UN);
+    ::close(fd);
+    if (slotIndex < 0) {
+      close();
+      return false;
+    }
+
+    uint64_t writeSeq = header->writeSeq.load(std::memory_order_acquire);
+    cursor = (fromOldest && writeSeq > header->capacity) ? writeSeq - header->capacity
+           : (fromOldest ? 0 : writeSeq);
+    header->readers[slotIndex].cursor.store(cursor, std::memory_order_release);
+    return true;
+  }
+
+  void close() {
+    if (!header) return;
+    if (slotIndex >= 0) header->readers[slotIndex].pid.store(0, std::memory_order_release);
+    munmap(header, mappedBytes);
+    header = nullptr;
+    records = nullptr;
+    slotIndex = -1;
+  }
+
+  // Returns the next record, or nullptr when caught up with the writer.
+  const SifRecord* next() {
+    uint64_t writeSeq = header->writeSeq.load(std::memory_order_acquire);
+    while (cursor < writeSeq) {
+      if (writeSeq - cursor > header->capacity) {
+        dropped += writeSeq - header->capacity - cursor;
+        cursor = writeSeq - header->capacity;
+      }
+      const SifRecord* rec = &records[cursor % header->capacity];
+      uint64_t expected = ++cursor;
+      header->readers[slotIndex].cursor.store(cursor, std::memory_order_release);
+      if (rec->seq.load(std::memory_order_acquire) == expected) return rec;
+      dropped++;
+    }
+    return nullptr;
+  }
+
+  // True if the record last returned by next() was not overwritten while in
+  // use.
+  bool stillValid(const SifRecord* rec) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return rec->seq.load(std::memory_order_relaxed) == cursor;
+  }
+
+  uint64_t position() const {
+    return cursor;
+  }
+
+  uint64_t droppedCount() const {
+    return dropped;
+  }
+
+  bool writerAlive() const {
+    return header->writerPid.load(std::memory_order_acquire) != 0;
+  }
+};
+
+#endif
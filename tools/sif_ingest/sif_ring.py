@@ -0,0 +1,141 @@
+"""Zero-copy reader for the sif_ingest shared-memory ring (see sif_ring.h).
+
+    from sif_ring import SifRing
+    ring = SifRing()                 # attaches to /dev/shm/sif_ring
+    for batch in ring.poll():        # numpy views straight into the segment
+        print(batch['rpm'].mean())
+
+`poll()` yields structured numpy arrays that alias the shared ring. Copy a
+batch (`batch.copy()`) if you need it after the writer may have wrapped.
+"""
+import fcntl
+import mmap
+import os
+import struct
+
+import numpy as np
+
+SIF_RING_MAGIC = 0x53494652
+SIF_RING_VERSION = 1
+SIF_RING_HEADER_SIZE = 4096
+SIF_RING_MAX_READERS = 16
+
+POWER_STATES = ['IDLE', 'COAST', 'LOAD', 'REGEN']
+
+RECORD_DTYPE = np.dtype([
+    ('seq', '<u8'),
+    ('host_time_ns', '<u8'),
+    ('device_time_us', '<u8'),
+    ('raw', 'u1', (12,)),
+    ('battery', '<i2'),
+    ('load_voltage', '<i2'),
+    ('rpm', '<i4'),
+    ('est_power', '<f4'),
+    ('speed_mode', 'u1'),
+    ('reverse', 'u1'),
+    ('brake', 'u1'),
+    ('regen', 'u1'),
+    ('power_state', 'u1'),
+    ('b2_direction', 'u1'),
+    ('reserved', 'u1', (10,)),
+])
+assert RECORD_DTYPE.itemsize == 64
+
+# magic, version, recordSize, capacity, writeSeq, linesParsed, linesRejected, writerPid
+_HEADER = struct.Struct('<IIIIQQQI')
+_WRITE_SEQ_OFFSET = 16
+_READERS_OFFSET = _HEADER.size + 4
+_READER_SLOT = struct.Struct('<IIQ')
+
+
+class SifRing:
+    def __init__(self, name='sif_ring', from_oldest=False):
+        fd = os.open(os.path.join('/dev/shm', name.lstrip('/')), os.O_RDWR)
+        try:
+            self._map = mmap.mmap(fd, 0)
+
+            magic, version, record_size, self.capacity = _HEADER.unpack_from(self._map, 0)[:4]
+            if magic != SIF_RING_MAGIC or version != SIF_RING_VERSION or record_size != RECORD_DTYPE.itemsize:
+                raise ValueError(f"{name} is not a version {SIF_RING_VERSION} SIF ring")
+
+            self.records = np.frombuffer(self._map, dtype=RECORD_DTYPE, count=self.capacity,
+                                         offset=SIF_RING_HEADER_SIZE)
+            self.dropped = 0
+            self._slot = self._claim_slot(fd)
+        finally:
+            os.close(fd)
+
+        write_seq = self._write_seq()
+        if from_oldest:
+            self.cursor = max(0, write_seq - self.capacity)
+        else:
+            self.cursor = write_seq
+        self._store_cursor()
+
+    def _write_seq(self):
+        return struct.unpack_from('<Q', self._map, _WRITE_SEQ_OFFSET)[0]
+
+    def _slot_offset(self, index):
+        return _READERS_OFFSET + index * _READER_SLOT.size
+
+    def _claim_slot(self, fd):
+        # Python has no CAS on shared memory, so every reader (SifRingReader
+        # included) claims slots under an exclusive flock on the segment.
+        pid = os.getpid()
+        fcntl.flock(fd, fcntl.LOCK_EX)
+        try:
+            for index in range(SIF_RING_MAX_READERS):
+                offset = self._slot_offset(index)
+                if struct.unpack_from('<I', self._map, offset)[0] == 0:
+                    struct.pack_into('<I', self._map, offset, pid)
+                    return index
+        finally:
+            fcntl.flock(fd, fcntl.LOCK_UN)
+        raise RuntimeError("no free reader slots in SIF ring")
+
+    def _store_cursor(self):
+        struct.pack_into('<Q', self._map, self._slot_offset(self._slot) + 8, self.cursor)
+
+    def writer_alive(self):
+        return struct.unpack_from('<I', self._map, _HEADER.size - 4)[0] != 0
+
+    def lag(self):
+        return self._write_seq() - self.cursor
+
+    def poll(self):
+        """Yield contiguous batches of new records, oldest first."""
+        write_seq = self._write_seq()
+        if write_seq - self.cursor > self.capacity:
+            self.dropped += write_seq - self.capacity - self.cursor
+            self.cursor = write_seq - self.capacity
+
+        while self.cursor < write_seq:
+            start = self.cursor % self.capacity
+            count = min(write_seq - self.cursor, self.capacity - start)
+            batch = self.records[start:start + count]
+            # Slots the writer lapped while we were behind carry a newer seq.
+            expected = np.arange(self.cursor + 1, self.cursor + count + 1, dtype=np.uint64)
+            valid = batch['seq'] == expected
+            self.cursor += count
+            self._store_cursor()
+            if valid.all():
+                yield batch
+            else:
+                self.dropped += int(count - valid.sum())
+                yield batch[valid]
+
+    def close(self):
+        if self._map is not None:
+            struct.pack_into('<I', self._map, self._slot_offset(self._slot), 0)
+            self.records = None
+            try:
+                self._map.close()
+            except BufferError:
+                pass  # batches still alias the segment; it unmaps when they go
+            self._map = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()